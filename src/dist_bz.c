@@ -0,0 +1,116 @@
+/************************************************************************
+ * @file dist_bz.c
+ * @brief Brouwer-Zimmermann (BZ) information sets and lower bound
+ *
+ * The enumeration of low-weight messages is done by the worker
+ * threads in `dist_m4ri.c`; here we only construct the generator
+ * matrices systematic on disjoint information sets.
+ *
+ * A. E. Brouwer, "Bounds on the size of linear codes," in Handbook
+ * of Coding Theory, 1998; M. Grassl, "Searching for linear codes with
+ * large minimum distance," in Discovering Mathematics with Magma, 2006.
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+#include "dist_bz.h"
+
+bz_t * bz_init(const csr_t * const H, const int debug){
+  const int n = H->cols;
+  bz_t *bz = calloc(1, sizeof(bz_t));
+  mzd_t *G0 = mzd_generator_from_csr(NULL, H);
+  const int k = G0->nrows;
+  bz->n = n;
+  bz->k = k;
+  bz->kj = malloc(sizeof(int) * (n + 1));
+  bz->G = malloc(sizeof(mzd_t *) * (n + 1));
+  if ((!bz->kj) || (!bz->G))
+    ERROR("memory allocation failed!\n");
+  if (k == 0){
+    mzd_free(G0);
+    return bz;
+  }
+
+  int *used = calloc(n, sizeof(int));
+  int *cols = malloc(sizeof(int) * n);
+  mzd_t *M = mzd_init(k, n);
+  mzp_t *piv = mzp_init(n);
+  word *tab = mzd_echelon_m4ri_tab(M);
+  if ((!used) || (!cols))
+    ERROR("memory allocation failed!\n");
+
+  while(1){
+    /** columns not used yet go first */
+    int nu = 0;
+    for(int c = 0; c < n; c++)
+      if(!used[c])
+	cols[nu++] = c;
+    for(int c = 0, m = nu; c < n; c++)
+      if(used[c])
+	cols[m++] = c;
+    mzd_set_ui(M, 0);
+    for(int r = 0; r < k; r++)
+      for(int i = 0; i < n; i++)
+	if(mzd_read_bit(G0, r, cols[i]))
+	  mzd_write_bit(M, r, i, 1);
+    const rci_t rank = mzd_echelon_m4ri(M, piv, tab);
+    if (rank != k)
+      ERROR("unexpected rank=%d of the generator matrix, k=%d", rank, k);
+    int kj = 0; /** pivots among the unused columns come first */
+    while((kj < rank) && (piv->values[kj] < nu))
+      kj++;
+    if (kj == 0)
+      break;
+    for(int i = 0; i < kj; i++)
+      used[cols[piv->values[i]]] = 1;
+    /** back to the original column order */
+    mzd_t *Gj = mzd_init(k, n);
+    for(int r = 0; r < k; r++)
+      for(int i = 0; i < n; i++)
+	if(mzd_read_bit(M, r, i))
+	  mzd_write_bit(Gj, r, cols[i], 1);
+    bz->G[bz->num] = Gj;
+    bz->kj[bz->num++] = kj;
+  }
+
+  if (debug & 2){
+    fprintf(stderr, "# BZ: n=%d k=%d, %d information sets of ranks", n, k, bz->num);
+    for(int j = 0; j < bz->num; j++)
+      fprintf(stderr, " %d", bz->kj[j]);
+    fprintf(stderr, "\n");
+  }
+
+  free(tab);
+  mzp_free(piv);
+  mzd_free(M);
+  free(cols);
+  free(used);
+  mzd_free(G0);
+  return bz;
+}
+
+bz_t * bz_free(bz_t *bz){
+  if (bz){
+    for(int j = 0; j < bz->num; j++)
+      mzd_free(bz->G[j]);
+    free(bz->G);
+    free(bz->kj);
+    free(bz);
+  }
+  return NULL;
+}
+
+int bz_lower_bound(const bz_t * const bz, const int w){
+  int lb = 0;
+  for(int j = 0; j < bz->num; j++){
+    const int extra = w + 1 - (bz->k - bz->kj[j]);
+    if (extra > 0)
+      lb += extra;
+  }
+  return lb;
+}
@@ -0,0 +1,73 @@
+#ifndef DIST_BZ_H
+#define DIST_BZ_H
+
+/************************************************************************
+ * @file dist_bz.h
+ * @brief Brouwer-Zimmermann (BZ) information sets and lower bound
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** min density of `H` to use BZ instead of CC with `bz=-1` (auto) */
+#define BZ_AUTO_DENSITY 0.1
+
+/**
+ * @brief Generator matrices of `ker H` systematic on disjoint information sets.
+ *
+ * In `G[j]` (columns in the original order) rows `0...kj[j]-1` form
+ * the identity on the columns of the information set `j`, and the
+ * remaining `k-kj[j]` rows vanish there.  Information set `0` has
+ * full rank `kj[0]=k`.
+ */
+typedef struct {
+  int n;        /* code length */
+  int k;        /* dimension of `ker H` */
+  int num;      /* number of disjoint information sets */
+  int *kj;      /* rank of each information set */
+  mzd_t **G;    /* generator matrices, `k` by `n` */
+} bz_t;
+
+/**
+ * @brief Construct disjoint information sets of `ker H`.
+ *
+ * Each set is chosen greedily among the columns not used by the
+ * previous ones, until no columns of non-zero rank are left.
+ *
+ * @param H Parity check matrix (compressed CSR form).
+ * @param debug Debug bitmap; `2` prints the ranks.
+ * @return Newly allocated structure, free with `bz_free()`.
+ */
+bz_t * bz_init(const csr_t * const H, const int debug);
+
+/** @brief free the BZ structure, return NULL */
+bz_t * bz_free(bz_t *bz);
+
+/**
+ * @brief BZ lower bound on the weight of codewords not yet seen.
+ *
+ * After all messages of weight up to `w` have been enumerated in
+ * every information set, any remaining codeword has weight at least
+ * `sum_j max(0, w+1-(k-kj[j]))`.
+ *
+ * @param bz The BZ structure.
+ * @param w Max message weight enumerated.
+ * @return The lower bound.
+ */
+int bz_lower_bound(const bz_t * const bz, const int w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIST_BZ_H */
@@ -116,13 +116,13 @@ int start_CC_recurs(one_vec_t *err, one_vec_t *urr, one_vec_t * const syn[],
 	  assert(err->wei == current_limit);
 	  if(!swei){
 	    if((!mL) ||  /** classical code */
-	       (sparse_syndrome_non_zero(mL, err->wei, err->vec))){
+	       (colmask_syndrome_non_zero(p->maskL, err->wei, err->vec))){
 	      if(debug&32){
 		printf("swei=%d *** success ***\n",swei);
 		one_vec_print(err);
 		one_vec_print(syn[w+1]);
 	      }
-              p->codewords = codeword_add_maybe(p, err->vec, err->wei);
+              codeword_add_maybe(p, err->vec, err->wei);
               if (p->maxC && p->num_cws >= p->maxC) {
                 return 1;
               }
@@ -222,8 +222,8 @@ int do_CC_dist(params_t * const p){
       else{ // w==1
 	if(!swei){	/** verify the vector */
 	  if((!mL) ||  /** classical code */
-	     (sparse_syndrome_non_zero(mL, err->wei, err->vec))){
-            p->codewords = codeword_add_maybe(p, err->vec, err->wei);
+	     (colmask_syndrome_non_zero(p->maskL, err->wei, err->vec))){
+            codeword_add_maybe(p, err->vec, err->wei);
             if (p->maxC && p->num_cws >= p->maxC) {
               result = 1;
               break;
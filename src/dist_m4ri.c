@@ -35,6 +35,7 @@
 #include <pthread.h>
 #include <math.h>
 #include <limits.h>
+#include <errno.h>
 #include <m4ri/m4ri.h>
 
 #include "mmio.h"
@@ -44,44 +45,10 @@
 #include "util_io.h"
 #include "dist_m4ri.h"
 #include "dist_cc.h"
-
-/* Mutex protecting M4RI's internal non-thread-safe MMC memory cache */
-static pthread_mutex_t m4ri_mem_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-static inline mzd_t *safe_mzd_from_csr(mzd_t *dst, const csr_t *p) {
-  pthread_mutex_lock(&m4ri_mem_mutex);
-  mzd_t *res = mzd_from_csr(dst, p);
-  pthread_mutex_unlock(&m4ri_mem_mutex);
-  return res;
-}
-
-static inline mzd_t *safe_mzd_init(rci_t r, rci_t c) {
-  pthread_mutex_lock(&m4ri_mem_mutex);
-  mzd_t *res = mzd_init(r, c);
-  pthread_mutex_unlock(&m4ri_mem_mutex);
-  return res;
-}
-
-static inline void safe_mzd_free(mzd_t *M) {
-  if (!M) return;
-  pthread_mutex_lock(&m4ri_mem_mutex);
-  mzd_free(M);
-  pthread_mutex_unlock(&m4ri_mem_mutex);
-}
-
-static inline mzp_t *safe_mzp_init(rci_t length) {
-  pthread_mutex_lock(&m4ri_mem_mutex);
-  mzp_t *res = mzp_init(length);
-  pthread_mutex_unlock(&m4ri_mem_mutex);
-  return res;
-}
-
-static inline void safe_mzp_free(mzp_t *P) {
-  if (!P) return;
-  pthread_mutex_lock(&m4ri_mem_mutex);
-  mzp_free(P);
-  pthread_mutex_unlock(&m4ri_mem_mutex);
-}
+#include "dist_bz.h"
+#include "util_bmat.h"
+#include "util_spgauss.h"
+#include "util_sys.h"
 
 static inline double get_time_sec(void) {
   struct timespec ts;
@@ -112,9 +79,42 @@ static inline mzp_t * mzp_rand_thread(mzp_t *q, rci_t length, uint64_t *state) {
   return q;
 }
 
+/**
+ * @brief CC (or BZ) round for cluster weight `w`, kept in slot `w&1`
+ * of `distfork_ctx_t::cc_rd`, so that idle CC threads can start round
+ * `w+1` while round `w` is finishing.  The weight is stored with the
+ * next start column, so that a thread can not take a column of a
+ * round which has been replaced.
+ */
+typedef struct {
+  atomic_llong next;      /* `(w<<32)|c`: `c` is the next start column of round `w` */
+  atomic_int active;      /* threads holding a start column */
+  atomic_long pending;    /* CC subtrees queued or being searched */
+  atomic_int found;       /* smallest weight of codewords found (0 if none) */
+  atomic_bool stop;       /* codeword found which stops the search once the round is current */
+  atomic_llong busy_us;   /* thread time spent in the round, microseconds */
+  int *order;             /* CC: start columns in the order handed out */
+  atomic_llong *cost;     /* CC: clusters checked in the tree of each start column */
+} cc_round_t;
+
+/**
+ * @brief Columns of `H` by their syndrome (row set), for the last CC
+ * level: the only columns which complete a cluster are the ones equal
+ * to its syndrome.  Columns with the same syndrome are consecutive.
+ */
+typedef struct {
+  int *col;      /* non-zero columns, by syndrome */
+  int *beg;      /* syndrome `g` is that of `col[beg[g]...beg[g+1]-1]` */
+  int *slot;     /* open addressing index, `g+1` (0 if empty) */
+  size_t mask;
+} cc_coltab_t;
+
 typedef struct {
   params_t *p;
   int num_threads;
+  int num_rw;                  /* threads `0...num_rw-1` may run RW, limited by the memory budget */
+  int *cpu;                    /* with `affinity`: CPU of thread `tid` is `cpu[tid % ncpu]` */
+  int ncpu;
   double timeout;
   double start_time;
   int dexp;
@@ -125,24 +125,36 @@ typedef struct {
   atomic_int cc_found_weight;  /* weight of codeword if CC found exact */
   atomic_bool stop_flag;       /* signals all threads to terminate */
 
+  /* Wake-ups of idle threads and of the coordinator, see `ctx_wait()` */
+  pthread_mutex_t ev_lock;
+  pthread_cond_t ev_cond;      /* with `CLOCK_MONOTONIC` */
+  atomic_ulong ev_seq;         /* number of events so far */
+  atomic_int ev_waiters;
+
   /* RW state */
   long total_rw_steps;
   atomic_long rw_steps_started;
   atomic_long rw_steps_completed;
 
-  /* CC state for current weight */
+  /* CC state: current round `cc_weight` and the look-ahead round `cc_weight+1` */
   atomic_int cc_weight;
-  atomic_int cc_col_next;
-  int cc_col_beg;
-  int cc_col_end;
+  cc_round_t cc_rd[2];
+  long long *cc_cost;          /* `cost` of the last completed CC round */
   csr_t *mHT_cc;
+  csr_t *mH_cc;                /* `H` with sorted rows, for `ccbranch` */
   int max_col_W;
+  cc_coltab_t cc_col;          /* columns by syndrome, for the last CC level */
+  csr_t *cc_nbr;               /* rows sharing a column with each row, for `cc_bound()`; NULL if too large */
+  bz_t *bz;                    /* BZ information sets, used instead of CC if not NULL */
   atomic_int cc_active_workers;
   atomic_int cc_target_workers;
   atomic_int cc_round_active;
+  struct CC_DEQUE_T *cc_dq;    /* per-thread deques of CC subtrees */
+  size_t cc_mitm_bytes;        /* `ccmitm`: size of the table of each thread */
+  atomic_int cc_hungry;        /* CC threads waiting for work */
 
-  /* Codeword synchronization */
-  pthread_mutex_t cw_mutex;
+  /* RW groups (`rwgroup>1`): threads `g*rwgroup...` share one RW work space */
+  struct RW_GROUP_T *rw_grp;
 
   /* Timing stats */
   double cc_time_per_weight[MAX_W];
@@ -152,198 +164,1601 @@ typedef struct {
   pthread_t *threads;
 } distfork_ctx_t;
 
+/** @brief atomically lower `*a` to `w`, with 0 meaning "not set"; return 1 if changed */
+static inline int atomic_min_nz(atomic_int *a, const int w) {
+  int cur = atomic_load(a);
+  while (cur == 0 || w < cur)
+    if (atomic_compare_exchange_weak(a, &cur, w))
+      return 1;
+  return 0;
+}
+
+/** @brief event count, to be read before checking for work */
+static inline unsigned long ctx_event(distfork_ctx_t *ctx) {
+  return atomic_load(&ctx->ev_seq);
+}
+
+/** @brief new work, end of a round, or stop: wake up the waiting threads */
+static void ctx_signal(distfork_ctx_t *ctx) {
+  atomic_fetch_add(&ctx->ev_seq, 1);
+  if (atomic_load(&ctx->ev_waiters) > 0) {
+    pthread_mutex_lock(&ctx->ev_lock);
+    pthread_cond_broadcast(&ctx->ev_cond);
+    pthread_mutex_unlock(&ctx->ev_lock);
+  }
+}
+
+/**
+ * @brief Wait for an event after `seq = ctx_event()`, or stop, or the
+ * timeout.  `ev_waiters` is raised before `ev_seq` is checked, and
+ * `ctx_signal()` does the opposite, so an event can not be missed.
+ */
+static void ctx_wait(distfork_ctx_t *ctx, const unsigned long seq) {
+  double end = ctx->start_time + ctx->timeout;
+  if (end > ctx->start_time + 1e8)
+    end = ctx->start_time + 1e8;
+  struct timespec ts;
+  ts.tv_sec = (time_t) end;
+  ts.tv_nsec = (long) ((end - (double) ts.tv_sec) * 1e9);
+  pthread_mutex_lock(&ctx->ev_lock);
+  atomic_fetch_add(&ctx->ev_waiters, 1);
+  while ((atomic_load(&ctx->ev_seq) == seq) && !atomic_load(&ctx->stop_flag))
+    if (pthread_cond_timedwait(&ctx->ev_cond, &ctx->ev_lock, &ts) == ETIMEDOUT)
+      break;
+  atomic_fetch_sub(&ctx->ev_waiters, 1);
+  pthread_mutex_unlock(&ctx->ev_lock);
+}
+
+/** @brief tell all threads to terminate */
+static void ctx_stop(distfork_ctx_t *ctx) {
+  atomic_store(&ctx->stop_flag, true);
+  ctx_signal(ctx);
+}
+
+/** CC: unexplored branches up to this depth can be handed to idle threads */
+#define CC_SPLIT_DEPTH 4
+
+/** @brief CC subtree of round `w`: all clusters extending `col[0...len-1]`
+    (in the order the columns were added); `col[len-1]` is not checked yet */
+typedef struct {
+  int w;
+  int len;
+  int col[CC_SPLIT_DEPTH];
+} cc_task_t;
+
+/** @brief deque of CC subtrees; the owner works at the tail, idle
+    threads steal from the head, i.e., the larger subtrees */
+typedef struct CC_DEQUE_T {
+  pthread_mutex_t lock;
+  cc_task_t *task;
+  int head, tail, cap;
+  atomic_int num;
+} cc_deque_t;
+
+/** @brief one level of the CC search: columns `list[i...end-1]` remain, those
+    of the first non-zero syndrome row, or at the last level the ones equal to
+    the syndrome; `col` went to position `pos` of `err` */
+typedef struct {
+  const int *list;
+  int i, end;
+  int col, pos;
+} cc_frame_t;
+
 typedef struct {
   distfork_ctx_t *ctx;
   int tid;
   int min_swei[MAX_W];
+  /* CC work space */
+  one_vec_t *err;       /* current cluster, ordered */
+  one_vec_t *urr;       /* same columns in the order added */
+  one_vec_t **syn;      /* syndrome at each level */
+  cc_frame_t *fr;
+  long long nodes;      /* clusters checked since the last `cc_round_t::cost` update */
+  uint32_t *mark;       /* rows covered in `cc_bound()`, or counted in `cc_branch()`, are `stamp` */
+  uint32_t stamp;
+  int *taken;           /* `cc_branch()`: columns of a marked row already in the cluster */
+  long long clusters;   /* clusters checked in all rounds */
+  struct CC_MITM_T *mt; /* `ccmitm` table, allocated when first used */
+  long long mitm_hit, mitm_miss;
 } worker_arg_t;
 
-/* Recursive CC worker function (interruptible) */
-static int start_CC_recurs_mt(one_vec_t *err, one_vec_t *urr, one_vec_t * const syn[],
-                              const int w_limit, const int max_col_wt,
-                              const csr_t * const mH, const csr_t * const mHT,
-                              worker_arg_t *warg) {
-  distfork_ctx_t *ctx = warg->ctx;
-  if (atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed)) {
+/**
+ * @brief `ccmitm` table of one thread: the second halves of CC clusters
+ * by the syndrome at depth `h`, for the start column `s` of round `w`.
+ *
+ * Entry at `data[off]`: the syndrome weight `t`, `t` rows, the number
+ * of second halves, then each as its length and sorted columns.  An
+ * index slot is `gen<<32 | (off+1)`; slots of an older `gen` are empty,
+ * so a new start column only increments `gen`.
+ */
+typedef struct CC_MITM_T {
+  int *data;
+  size_t used, size;     /* ints */
+  uint64_t *slot;
+  size_t mask, nslot;    /* `nslot` slots of the current `gen` in use */
+  uint32_t gen;
+  int s, w;
+  bool full;             /* no room, halves are no longer stored */
+  int *tmp;              /* second halves of the current syndrome */
+  size_t tmp_used, tmp_size;
+} cc_mitm_t;
+
+/** @brief queue subtrees of round `w` extending `pref[0...len-1]` by each of `cols[0...num-1]` */
+static void cc_deque_push(distfork_ctx_t *ctx, cc_deque_t *dq, const int w, const int *pref, const int len,
+                          const int *cols, const int num) {
+  pthread_mutex_lock(&dq->lock);
+  if (dq->head == dq->tail)
+    dq->head = dq->tail = 0;
+  if (dq->tail + num > dq->cap) {
+    dq->cap = 2 * (dq->tail + num);
+    dq->task = realloc(dq->task, sizeof(cc_task_t) * dq->cap);
+    if (!dq->task)
+      ERROR("memory allocation failed!\n");
+  }
+  for (int j = 0; j < num; j++) {
+    cc_task_t * const t = &dq->task[dq->tail++];
+    for (int l = 0; l < len; l++)
+      t->col[l] = pref[l];
+    t->col[len] = cols[j];
+    t->len = len + 1;
+    t->w = w;
+  }
+  /** counted before the current subtree is finished, see `cc_round_done()` */
+  atomic_fetch_add(&ctx->cc_rd[w & 1].pending, num);
+  atomic_fetch_add(&dq->num, num);
+  pthread_mutex_unlock(&dq->lock);
+  ctx_signal(ctx);
+}
+
+/** @brief take a subtree from the tail (`own`) or the head of the deque; return 1 on success */
+static int cc_deque_take(cc_deque_t *dq, cc_task_t *t, const bool own) {
+  if (atomic_load_explicit(&dq->num, memory_order_relaxed) == 0)
     return 0;
+  int ok = 0;
+  pthread_mutex_lock(&dq->lock);
+  if (dq->head < dq->tail) {
+    *t = own ? dq->task[--dq->tail] : dq->task[dq->head++];
+    atomic_fetch_sub(&dq->num, 1);
+    ok = 1;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return ok;
+}
+
+/** @brief last start column of round `w` (BZ: last task); with `ccpass`, clusters of any weight */
+static inline int cc_round_end(const distfork_ctx_t *ctx, const int w) {
+  if (ctx->bz)
+    return ctx->bz->num * ctx->bz->k - 1;
+  const int nvar = ctx->p->spaH->cols, wmin = ctx->p->ccpass ? 1 : w;
+  return (ctx->p->cend >= 0) ? minint(ctx->p->cend, nvar - wmin) : (nvar - wmin);
+}
+
+/** @brief CC start column with its cost in the last completed round */
+typedef struct {
+  long long cost;
+  int col;
+} cc_col_cost_t;
+
+/** @brief by decreasing cost, then by column */
+static int by_cost(const void *a, const void *b) {
+  const cc_col_cost_t * const x = a, * const y = b;
+  if (x->cost != y->cost)
+    return x->cost < y->cost ? 1 : -1;
+  return x->col - y->col;
+}
+
+/**
+ * @brief Open round `w` with the first start column `beg`; the slot
+ * must not be in use.  CC start columns are handed out largest tree
+ * first, with the cost measured in the last completed round (round
+ * `w-1`, or `w-2` for the look-ahead round), so that no large tree
+ * is left for the end of the round.
+ */
+static void cc_round_open(distfork_ctx_t *ctx, const int w, const int beg) {
+  cc_round_t * const rd = &ctx->cc_rd[w & 1];
+  if (rd->order) {
+    const int end = cc_round_end(ctx, w), num = end - beg + 1;
+    if (num > 0) {
+      cc_col_cost_t *a = malloc(sizeof(cc_col_cost_t) * num);
+      if (!a)
+        ERROR("memory allocation failed!\n");
+      for (int j = 0; j < num; j++) {
+        a[j].col = beg + j;
+        a[j].cost = ctx->cc_cost[beg + j];
+      }
+      qsort(a, num, sizeof(cc_col_cost_t), by_cost);
+      for (int j = 0; j < num; j++)
+        rd->order[beg + j] = a[j].col;
+      free(a);
+    }
+    for (int c = 0; c < ctx->p->spaH->cols; c++)
+      atomic_store_explicit(&rd->cost[c], 0, memory_order_relaxed);
   }
+  atomic_store(&rd->found, 0);
+  atomic_store(&rd->stop, false);
+  atomic_store(&rd->busy_us, 0);
+  atomic_store(&rd->next, ((long long) w << 32) | beg);
+}
+
+/** @brief keep the per-column cost of the completed round `w` to order the next rounds */
+static void cc_round_save_cost(distfork_ctx_t *ctx, const int w) {
+  const cc_round_t * const rd = &ctx->cc_rd[w & 1];
+  if (rd->cost)
+    for (int c = 0; c < ctx->p->spaH->cols; c++)
+      ctx->cc_cost[c] = atomic_load_explicit(&rd->cost[c], memory_order_relaxed);
+}
+
+/** @brief round `w` has been opened */
+static inline bool cc_round_is_open(distfork_ctx_t *ctx, const int w) {
+  return (atomic_load(&ctx->cc_rd[w & 1].next) >> 32) == w;
+}
+
+/** @brief CC round `w` is over: no start columns left, no threads busy, no subtrees left */
+static bool cc_round_done(distfork_ctx_t *ctx, const int w) {
+  cc_round_t * const rd = &ctx->cc_rd[w & 1];
+  const long long v = atomic_load(&rd->next);
+  return ((v >> 32) == w) && ((int) (v & 0xffffffff) > cc_round_end(ctx, w)) &&
+    (atomic_load(&rd->active) == 0) && (atomic_load(&rd->pending) == 0);
+}
+
+/** @brief take a start column `*col` of round `w`, counted in the
+    round's `active` until released by the caller; return 1 on success */
+static int cc_round_take(distfork_ctx_t *ctx, const int w, int *col) {
+  cc_round_t * const rd = &ctx->cc_rd[w & 1];
+  const int end = cc_round_end(ctx, w);
+  bool counted = false;
+  long long v = atomic_load(&rd->next);
+  while (((v >> 32) == w) && ((int) (v & 0xffffffff) <= end) && !atomic_load(&rd->stop)) {
+    if (!counted) { /** before the column is taken, see `cc_round_done()` */
+      atomic_fetch_add(&rd->active, 1);
+      counted = true;
+    }
+    if (atomic_compare_exchange_weak(&rd->next, &v, v + 1)) {
+      const int i = (int) (v & 0xffffffff);
+      *col = rd->order ? rd->order[i] : i;
+      return 1;
+    }
+  }
+  /** the round may have been kept open by this thread only */
+  if (counted && (atomic_fetch_sub(&rd->active, 1) == 1) && cc_round_done(ctx, w))
+    ctx_signal(ctx);
+  return 0;
+}
+
+/**
+ * @brief Record the CC codeword `vec[0...wei-1]` (sorted, zero syndrome)
+ * of round `w_limit` unless it is trivial.
+ * @return -1 if the search is to be stopped, 0 otherwise.
+ */
+static int cc_found(worker_arg_t *warg, const int * const vec, const int wei, const int w_limit) {
+  distfork_ctx_t *ctx = warg->ctx;
   params_t * const p = ctx->p;
-  const int w = err->wei;
-  int row = syn[w]->vec[0];
-  const csr_t * const mL = p->spaL;
-  const int col_min = urr->vec[0];
-
-  for (int i1 = mH->p[row]; i1 < mH->p[row+1]; i1++) {
-    const int col = mH->i[i1];
-    if (col > col_min) {
-      int pos = one_ordered_search(err, col);
-      if (pos == -1) {
-        urr->vec[w] = col;
-        urr->wei++;
-        pos = one_ordered_ins(err, col);
-        syn[w+1]->wei = 0;
-        int swei = one_csr_row_combine(syn[w+1], syn[w], mHT, col);
-
-        if (p->smax && swei > 0 && swei <= p->smax && (w + 1 < MAX_W)) {
-          if (swei < warg->min_swei[w + 1]) {
-            warg->min_swei[w + 1] = swei;
-          }
-        }
+  if (p->spaL && !colmask_syndrome_non_zero(p->maskL, wei, vec))
+    return 0;
+  cc_round_t * const rd = &ctx->cc_rd[w_limit & 1];
+  codeword_add_maybe(p, vec, wei);
+  atomic_min_nz(&ctx->dmax, wei);
+  atomic_min_nz(&ctx->dmax, atomic_load(&p->min_w));
+  atomic_min_nz(&rd->found, wei);
+  /** single pass: a lighter codeword may still come, see `cc_limit()` */
+  const bool lightest = (!p->ccpass) || (wei <= atomic_load(&ctx->dmin));
+  if ((!p->outC && p->maxC == 0 && lightest) || (p->maxC && p->num_cws >= p->maxC)) {
+    /** in the look-ahead round, wait until round `w_limit-1` is over */
+    if (atomic_load(&ctx->cc_weight) == w_limit)
+      ctx_stop(ctx);
+    else {
+      atomic_store(&rd->stop, true);
+      ctx_signal(ctx);
+    }
+    return -1;
+  }
+  return 0;
+}
 
-        int current_limit = w_limit;
-        int cur_dmax = atomic_load_explicit(&ctx->dmax, memory_order_relaxed);
-        if (cur_dmax > 0 && p->dW >= 0) {
-          current_limit = minint(w_limit, cur_dmax + p->dW);
+/** @brief the table of this thread for start column `s` of round `w`, emptied if it was for another one */
+static cc_mitm_t * cc_mitm_table(worker_arg_t *warg, const int s, const int w) {
+  cc_mitm_t *mt = warg->mt;
+  if (!mt) {
+    const size_t bytes = warg->ctx->cc_mitm_bytes;
+    mt = warg->mt = calloc(1, sizeof(cc_mitm_t));
+    if (!mt)
+      ERROR("memory allocation failed!\n");
+    /** a quarter for the index, 8 bytes per slot */
+    size_t nslot = 1024;
+    while (nslot * 2 * 32 <= bytes)
+      nslot *= 2;
+    mt->mask = nslot - 1;
+    mt->slot = calloc(nslot, sizeof(uint64_t));
+    mt->size = (bytes - nslot * sizeof(uint64_t)) / sizeof(int);
+    if (mt->size > UINT32_MAX - 1)
+      mt->size = UINT32_MAX - 1;
+    mt->data = malloc(sizeof(int) * (mt->size + 1));
+    mt->tmp_size = 1024;
+    mt->tmp = malloc(sizeof(int) * mt->tmp_size);
+    if ((!mt->slot) || (!mt->data) || (!mt->tmp))
+      ERROR("memory allocation failed!\n");
+    mt->s = -1;
+  }
+  if ((mt->s != s) || (mt->w != w)) {
+    mt->s = s;
+    mt->w = w;
+    mt->used = mt->nslot = 0;
+    mt->full = false;
+    if (++mt->gen == 0) { /** wrapped around */
+      memset(mt->slot, 0, sizeof(uint64_t) * (mt->mask + 1));
+      mt->gen = 1;
+    }
+  }
+  return mt;
+}
+
+static void cc_mitm_free(cc_mitm_t *mt) {
+  if (mt) {
+    free(mt->slot);
+    free(mt->data);
+    free(mt->tmp);
+    free(mt);
+  }
+}
+
+/** @brief append `n` ints to the second halves being collected */
+static void cc_mitm_put(cc_mitm_t *mt, const int * const v, const int n) {
+  if (mt->tmp_used + n > mt->tmp_size) {
+    while (mt->tmp_used + n > mt->tmp_size)
+      mt->tmp_size *= 2;
+    mt->tmp = realloc(mt->tmp, sizeof(int) * mt->tmp_size);
+    if (!mt->tmp)
+      ERROR("memory allocation failed!\n");
+  }
+  memcpy(mt->tmp + mt->tmp_used, v, sizeof(int) * n);
+  mt->tmp_used += n;
+}
+
+/** @brief next `stamp` for `warg->mark` */
+static inline uint32_t cc_stamp(worker_arg_t *warg) {
+  if (++warg->stamp == 0) { /** wrapped around */
+    memset(warg->mark, 0, sizeof(uint32_t) * warg->ctx->p->spaH->rows);
+    warg->stamp = 1;
+  }
+  return warg->stamp;
+}
+
+/**
+ * @brief `ccbranch=1`: branch on the row of the syndrome `sy` with the
+ * fewest columns left, i.e., columns `>s` not among `cols[0...num-1]`
+ * (the cluster so far).  Any unsatisfied row will do, since every
+ * codeword containing the cluster has one more column in it.  The
+ * frame `f` gets the columns `>s` of the row, none if there are none
+ * left.
+ */
+static void cc_branch(worker_arg_t *warg, const one_vec_t * const sy, const int s,
+                      const int * const cols, const int num, cc_frame_t * const f) {
+  const csr_t * const mH = warg->ctx->mH_cc, * const mHT = warg->ctx->mHT_cc;
+  uint32_t * const mark = warg->mark;
+  int * const taken = warg->taken;
+  const uint32_t st = cc_stamp(warg);
+  for (int j = 0; j < num; j++)
+    if (cols[j] > s)
+      for (int b = mHT->p[cols[j]]; b < mHT->p[cols[j] + 1]; b++) {
+        const int r = mHT->i[b];
+        if (mark[r] != st) {
+          mark[r] = st;
+          taken[r] = 0;
         }
+        taken[r]++;
+      }
+  f->list = mH->i;
+  f->i = f->end = 0;
+  int best = -1;
+  for (int j = 0; j < sy->wei; j++) {
+    const int r = sy->vec[j];
+    int lo = mH->p[r], hi = mH->p[r + 1];
+    while (lo < hi) { /** first column `>s` */
+      const int mid = (lo + hi) / 2;
+      if (mH->i[mid] <= s)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    const int left = mH->p[r + 1] - lo - ((mark[r] == st) ? taken[r] : 0);
+    if ((best < 0) || (left < best)) {
+      best = left;
+      f->i = lo;
+      f->end = mH->p[r + 1];
+      if (!left) { /** no codeword contains the cluster */
+        f->i = f->end;
+        break;
+      }
+    }
+  }
+}
 
-        if (err->wei < current_limit) {
-          if (swei) {
-            int result = start_CC_recurs_mt(err, urr, syn, w_limit, max_col_wt,
-                                            mH, mHT, warg);
-            if (result == 1) {
-              urr->wei--;
-              one_ordered_pos_del(err, col, pos);
-              return 1;
-            }
-          }
-        } else {
-          if (!swei) {
-            int nz = (!mL) || sparse_syndrome_non_zero(mL, err->wei, err->vec);
-            if (nz) {
-              bool stop = false;
-              pthread_mutex_lock(&ctx->cw_mutex);
-              p->codewords = codeword_add_maybe(p, err->vec, err->wei);
-              int cur_d = atomic_load(&ctx->dmax);
-              if (p->min_w < cur_d || cur_d == 0) {
-                atomic_store(&ctx->dmax, p->min_w);
-              }
-              int cur_cc_found = atomic_load(&ctx->cc_found_weight);
-              if (cur_cc_found == 0 || err->wei < cur_cc_found) {
-                atomic_store(&ctx->cc_found_weight, err->wei);
-              }
-              if (!p->outC && p->maxC == 0) {
-                atomic_store(&ctx->stop_flag, true);
-                stop = true;
-              }
-              if (p->maxC && p->num_cws >= p->maxC) {
-                atomic_store(&ctx->stop_flag, true);
-                stop = true;
-              }
-              pthread_mutex_unlock(&ctx->cw_mutex);
-
-              if (stop) {
-                urr->wei--;
-                one_ordered_pos_del(err, col, pos);
-                return 1;
-              }
-            }
+/**
+ * @brief Lower bound on the columns needed to clear the syndrome `sy`:
+ * 1 if it needs more than `r`.  A column clears at most `max_col_W`
+ * rows, and rows of `sy` no two of which are in the same column (taken
+ * greedily) need a column each.
+ */
+static int cc_bound(worker_arg_t *warg, const one_vec_t * const sy, const int r) {
+  distfork_ctx_t * const ctx = warg->ctx;
+  const int t = sy->wei;
+  if (r < 2)
+    return 0; /** the last column is looked up, see `cc_frame_open()` */
+  if (t > r * ctx->max_col_W)
+    return 1;
+  if (t <= r)
+    return 0;
+  const csr_t * const nbr = ctx->cc_nbr;
+  if (!nbr)
+    return 0;
+  uint32_t * const mark = warg->mark;
+  const uint32_t st = cc_stamp(warg);
+  int num = 0;
+  for (int j = 0; j < t; j++) {
+    const int row = sy->vec[j];
+    if (mark[row] == st)
+      continue;
+    if (++num > r)
+      return 1;
+    for (int a = nbr->p[row]; a < nbr->p[row + 1]; a++)
+      mark[nbr->i[a]] = st;
+  }
+  return 0;
+}
+
+/**
+ * @brief 1 if no cluster of weight `w+1...limit` extending one of
+ * weight `w` with syndrome weight `swei` can lower `min_swei` (`smax`):
+ * each column changes the syndrome weight by at most `max_col_W`.
+ */
+static inline int cc_swei_done(const worker_arg_t *warg, const int w, const int swei, const int limit) {
+  const int smax = warg->ctx->p->smax;
+  if (!smax)
+    return 1;
+  for (int k = w + 1; (k <= limit) && (k < MAX_W); k++)
+    if (swei - (k - w) * warg->ctx->max_col_W < minint(smax + 1, warg->min_swei[k]))
+      return 0;
+  return 1;
+}
+
+/** CC: largest list of row neighbors for `cc_bound()`, entries */
+#define CC_NBR_MAX (1 << 26)
+
+/** @brief rows sharing a column with each row of `mH` (itself included), NULL if more than `max_nz` */
+static csr_t * cc_row_nbrs(const csr_t * const mH, const csr_t * const mHT, const long long max_nz) {
+  const int m = mH->rows;
+  int * const last = malloc(sizeof(int) * (m + 1));
+  if (!last)
+    ERROR("memory allocation failed!\n");
+  csr_t *nbr = NULL;
+  long long nz = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    for (int j = 0; j < m; j++)
+      last[j] = -1;
+    nz = 0;
+    for (int row = 0; row < m; row++) {
+      if (nbr)
+        nbr->p[row] = nz;
+      for (int a = mH->p[row]; a < mH->p[row + 1]; a++)
+        for (int b = mHT->p[mH->i[a]]; b < mHT->p[mH->i[a] + 1]; b++) {
+          const int j = mHT->i[b];
+          if (last[j] != row) {
+            last[j] = row;
+            if (nbr)
+              nbr->i[nz] = j;
+            nz++;
           }
         }
-        urr->wei--;
-        one_ordered_pos_del(err, col, pos);
+    }
+    if (nbr) {
+      nbr->p[m] = nz;
+      nbr->nz = -1;
+    }
+    else if (nz > max_nz)
+      break;
+    else
+      nbr = csr_init(NULL, m, m, nz + 1);
+  }
+  free(last);
+  return nbr;
+}
+
+/** @brief index the non-zero columns of `H` by their syndrome, the (sorted) rows of `mHT` */
+static void cc_coltab_init(cc_coltab_t *tab, const csr_t * const mHT) {
+  const int n = mHT->rows;
+  size_t nslot = 2;
+  while (nslot < 2 * (size_t) n)
+    nslot *= 2;
+  tab->mask = nslot - 1;
+  tab->slot = calloc(nslot, sizeof(int));
+  tab->col = malloc(sizeof(int) * (n + 1));
+  tab->beg = calloc(n + 2, sizeof(int));
+  int * const grp = malloc(sizeof(int) * (n + 1)); /* syndrome of each column */
+  int * const one = malloc(sizeof(int) * (n + 1)); /* a column of each syndrome */
+  if ((!tab->slot) || (!tab->col) || (!tab->beg) || (!grp) || (!one))
+    ERROR("memory allocation failed!\n");
+  int ng = 0;
+  for (int c = 0; c < n; c++) {
+    const int t = mHT->p[c + 1] - mHT->p[c];
+    const int * const v = mHT->i + mHT->p[c];
+    grp[c] = -1;
+    if (!t)
+      continue;
+    unsigned hashv;
+    HASH_VALUE(v, sizeof(int) * t, hashv);
+    size_t i = hashv & tab->mask;
+    for (; tab->slot[i]; i = (i + 1) & tab->mask) {
+      const int r = one[tab->slot[i] - 1];
+      if ((mHT->p[r + 1] - mHT->p[r] == t) && (memcmp(mHT->i + mHT->p[r], v, sizeof(int) * t) == 0))
+        break;
+    }
+    if (!tab->slot[i]) {
+      one[ng] = c;
+      tab->slot[i] = ++ng;
+    }
+    grp[c] = tab->slot[i] - 1;
+    tab->beg[grp[c] + 1]++;
+  }
+  for (int g = 0; g < ng; g++) {
+    tab->beg[g + 1] += tab->beg[g];
+    one[g] = tab->beg[g];
+  }
+  for (int c = 0; c < n; c++)
+    if (grp[c] >= 0)
+      tab->col[one[grp[c]]++] = c;
+  free(grp);
+  free(one);
+}
+
+static void cc_coltab_free(cc_coltab_t *tab) {
+  free(tab->col);
+  free(tab->beg);
+  free(tab->slot);
+}
+
+/** @brief bytes of a CSR matrix, 0 for NULL */
+static long long cc_csr_bytes(const csr_t * const mat) {
+  return mat ? (long long) sizeof(int) * (mat->rows + 1 + mat->nzmax) : 0;
+}
+
+/** @brief bytes of the CC tables shared by all threads, counted in the CC share of the memory budget */
+static long long cc_tables_bytes(const distfork_ctx_t * const ctx) {
+  const int n = ctx->mHT_cc->rows;
+  return cc_csr_bytes(ctx->mHT_cc) + cc_csr_bytes(ctx->mH_cc) + cc_csr_bytes(ctx->cc_nbr) +
+    (long long) sizeof(int) * (ctx->cc_col.mask + 1 + 2 * n + 3);
+}
+
+/** @brief the last CC level: columns equal to the syndrome `sy` go to the frame `f`, if any */
+static void cc_coltab_find(const distfork_ctx_t *ctx, const one_vec_t * const sy, cc_frame_t *f) {
+  const cc_coltab_t * const tab = &ctx->cc_col;
+  const csr_t * const mHT = ctx->mHT_cc;
+  const int t = sy->wei;
+  f->list = tab->col;
+  f->i = f->end = 0;
+  if (t > ctx->max_col_W)
+    return; /** no column clears it */
+  unsigned hashv;
+  HASH_VALUE(sy->vec, sizeof(int) * t, hashv);
+  for (size_t i = hashv & tab->mask; tab->slot[i]; i = (i + 1) & tab->mask) {
+    const int g = tab->slot[i] - 1, c = tab->col[tab->beg[g]];
+    if ((mHT->p[c + 1] - mHT->p[c] == t) && (memcmp(mHT->i + mHT->p[c], sy->vec, sizeof(int) * t) == 0)) {
+      f->i = tab->beg[g];
+      f->end = tab->beg[g + 1];
+      return;
+    }
+  }
+}
+
+/**
+ * @brief All second halves `B` for the syndrome `syn[h]`: sets of up to
+ * `r` columns `>s` which clear it when added by the CC rule, i.e., a
+ * column of the first non-zero syndrome row each time.  The first half
+ * is ignored, so the result only depends on the syndrome.  Each `B`
+ * (length, sorted columns) goes to `mt->tmp`.
+ * @return 1 if the search was stopped, 0 otherwise.
+ */
+static int cc_mitm_halves(worker_arg_t *warg, cc_mitm_t *mt, const int h, const int r, const int w_limit) {
+  distfork_ctx_t *ctx = warg->ctx;
+  const csr_t * const mH = ctx->p->spaH;
+  one_vec_t * const * const syn = warg->syn;
+  const atomic_bool * const stop = &ctx->cc_rd[w_limit & 1].stop;
+  const int s = mt->s;
+  cc_frame_t fr[MAX_W];
+  int b[MAX_W + 1];
+  int d = 0;
+  if (ctx->p->ccbranch)
+    cc_branch(warg, syn[h], s, NULL, 0, &fr[0]);
+  else {
+    fr[0].list = mH->i;
+    fr[0].i = mH->p[syn[h]->vec[0]];
+    fr[0].end = mH->p[syn[h]->vec[0] + 1];
+  }
+  while (1) {
+    if (fr[d].i == fr[d].end) {
+      if (d-- == 0)
+        break;
+      continue;
+    }
+    if ((((++warg->nodes) & 1023) == 0) && (atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed) ||
+                                          atomic_load_explicit(stop, memory_order_relaxed)))
+      return 1;
+    const int col = fr[d].list[fr[d].i++];
+    if (col <= s)
+      continue;
+    int dup = 0;
+    for (int j = 0; j < d; j++)
+      dup |= (b[j + 1] == col);
+    if (dup)
+      continue;
+    b[d + 1] = col;
+    syn[h + d + 1]->wei = 0;
+    if (!one_csr_row_combine(syn[h + d + 1], syn[h + d], ctx->mHT_cc, col)) {
+      int c[MAX_W + 1], tmp[MAX_W];
+      c[0] = d + 1;
+      memcpy(c + 1, b + 1, sizeof(int) * (d + 1));
+      sort_rci_t(c + 1, d + 1, tmp);
+      cc_mitm_put(mt, c, d + 2);
+    }
+    else if ((d + 1 < r) && !cc_bound(warg, syn[h + d + 1], r - d - 1)) {
+      d++;
+      if (d + 1 == r)
+        cc_coltab_find(ctx, syn[h + d], &fr[d]);
+      else if (ctx->p->ccbranch)
+        cc_branch(warg, syn[h + d], s, b + 1, d, &fr[d]);
+      else {
+        const int row = syn[h + d]->vec[0];
+        fr[d].list = mH->i;
+        fr[d].i = mH->p[row];
+        fr[d].end = mH->p[row + 1];
       }
     }
   }
   return 0;
 }
 
-/* Run RW batch */
-static void run_rw_steps(distfork_ctx_t *ctx, int n_steps,
-                         mzd_t *mH, mzd_t *mHT, rci_t *ee,
-                         mzp_t *perm, mzp_t *pivs, mzp_t *pivs_srtd, mzp_t *skip_pivs,
-                         uint64_t *rng_state, int tid) {
+/**
+ * @brief Meet in the middle: complete the cluster `err` of weight `h`
+ * (non-zero syndrome `syn[h]`) to codewords of weight `limit` with the
+ * second halves for its syndrome, taken from the table or found and
+ * stored.  Same codewords as the CC search below `err`: the columns
+ * added to `err` by the search are one of its second halves.
+ * @return -1 if the search is to be stopped, 0 otherwise.
+ */
+static int cc_mitm(worker_arg_t *warg, const int limit, const int w_limit) {
+  const one_vec_t * const err = warg->err;
+  const one_vec_t * const sy = warg->syn[err->wei];
+  const int h = err->wei, t = sy->wei;
+  cc_mitm_t * const mt = cc_mitm_table(warg, warg->urr->vec[0], w_limit);
+  unsigned hashv;
+  HASH_VALUE(sy->vec, sizeof(int) * t, hashv);
+  size_t i = hashv & mt->mask;
+  const int *halves = NULL;
+  size_t len = 0;
+  for (; (mt->slot[i] >> 32) == mt->gen; i = (i + 1) & mt->mask) {
+    const int * const e = mt->data + (uint32_t) mt->slot[i] - 1;
+    if ((e[0] == t) && (memcmp(e + 1, sy->vec, sizeof(int) * t) == 0)) {
+      halves = e + t + 2;
+      len = e[t + 1];
+      warg->mitm_hit++;
+      break;
+    }
+  }
+  if (!halves) {
+    warg->mitm_miss++;
+    mt->tmp_used = 0;
+    if (cc_mitm_halves(warg, mt, h, limit - h, w_limit))
+      return 0; /** stopped, nothing stored */
+    halves = mt->tmp;
+    len = mt->tmp_used;
+    /** store unless full; the index is kept at most half full */
+    if ((!mt->full) && ((mt->used + t + 2 + len > mt->size) || (2 * (mt->nslot + 1) > mt->mask + 1)))
+      mt->full = true;
+    if (!mt->full) {
+      int * const e = mt->data + mt->used;
+      e[0] = t;
+      memcpy(e + 1, sy->vec, sizeof(int) * t);
+      e[t + 1] = (int) len;
+      memcpy(e + t + 2, mt->tmp, sizeof(int) * len);
+      mt->slot[i] = ((uint64_t) mt->gen << 32) | (mt->used + 1);
+      mt->used += t + 2 + len;
+      mt->nslot++;
+      halves = e + t + 2;
+    }
+  }
+  /** codewords from second halves disjoint with `err` */
+  int vec[MAX_W];
+  for (size_t j = 0; j < len; j += halves[j] + 1) {
+    const int nb = halves[j];
+    if (warg->ctx->p->ccpass ? (h + nb > limit) : (h + nb != limit))
+      continue; /** lighter ones come from earlier rounds, unless `ccpass` */
+    const int * const b = halves + j + 1;
+    int a = 0, c = 0, cnt = 0;
+    while ((a < h) || (c < nb)) {
+      if ((c == nb) || ((a < h) && (err->vec[a] < b[c])))
+        vec[cnt++] = err->vec[a++];
+      else if ((a == h) || (b[c] < err->vec[a]))
+        vec[cnt++] = b[c++];
+      else
+        break; /** common column */
+    }
+    if ((cnt == h + nb) && (cc_found(warg, vec, cnt, w_limit) < 0))
+      return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Weight limit of CC round `w_limit`, lowered to `dmax+dW` once
+ * a codeword is found; in a single pass (`ccpass`) without `outC`, to
+ * `dmax-1`, since only lighter codewords are of interest.
+ */
+static inline int cc_limit(distfork_ctx_t *ctx, const int w_limit) {
+  const int cur_dmax = atomic_load_explicit(&ctx->dmax, memory_order_relaxed);
+  if (cur_dmax > 0 && ctx->p->ccpass && !ctx->p->outC)
+    return minint(w_limit, cur_dmax - 1);
+  if (cur_dmax > 0 && ctx->p->dW >= 0)
+    return minint(w_limit, cur_dmax + ctx->p->dW);
+  return w_limit;
+}
+
+/**
+ * @brief Add column `col` to the CC cluster `err` of weight `w`: the
+ * body of the loop over the first non-zero syndrome row.
+ * @return 1 if the cluster is to be extended (`col` is left in `err`),
+ * -1 to stop the search, 0 otherwise.
+ */
+static int cc_add_col(worker_arg_t *warg, const int col, const int w_limit) {
+  distfork_ctx_t *ctx = warg->ctx;
   params_t * const p = ctx->p;
-  const csr_t * const spaL0 = p->spaL;
+  one_vec_t * const err = warg->err, * const urr = warg->urr;
+  one_vec_t * const * const syn = warg->syn;
+  const int w = err->wei;
+  warg->nodes++;
+  if ((col <= urr->vec[0]) || (one_ordered_search(err, col) != -1))
+    return 0;
+  urr->vec[w] = col;
+  urr->wei++;
+  const int pos = one_ordered_ins(err, col);
+  warg->fr[w].col = col;
+  warg->fr[w].pos = pos;
+  syn[w+1]->wei = 0;
+  int swei = one_csr_row_combine(syn[w+1], syn[w], ctx->mHT_cc, col);
+
+  if (p->smax && swei > 0 && swei <= p->smax && (w + 1 < MAX_W)) {
+    if (swei < warg->min_swei[w + 1]) {
+      warg->min_swei[w + 1] = swei;
+    }
+  }
+
+  const int current_limit = cc_limit(ctx, w_limit);
+  int ret = 0;
+  if (err->wei < current_limit) {
+    /** not cut by the bound, `cc_bound()` */
+    if (swei && !(cc_bound(warg, syn[w+1], current_limit - err->wei) &&
+                  cc_swei_done(warg, err->wei, swei, current_limit))) {
+      /** the rest from the table of second halves */
+      if (p->ccmitm && (err->wei == (w_limit + 1) / 2) && (current_limit - err->wei >= 2))
+        ret = cc_mitm(warg, current_limit, w_limit);
+      else
+        return 1;
+    }
+    else if ((!swei) && p->ccpass) /** lighter codeword, found in an earlier round otherwise */
+      ret = cc_found(warg, err->vec, err->wei, w_limit);
+  } else if (!swei)
+    ret = cc_found(warg, err->vec, err->wei, w_limit);
+  urr->wei--;
+  one_ordered_pos_del(err, col, pos);
+  return ret;
+}
+
+/**
+ * @brief Start a new level of the CC search for the cluster `err` of
+ * weight `d`.  At the last level only the columns equal to the
+ * syndrome are tried, unless one of the others may still lower
+ * `min_swei` (`smax`); adding a column leaves a syndrome of weight at
+ * least `syn[d]->wei - max_col_W`.
+ */
+static inline void cc_frame_open(worker_arg_t *warg, const int d, const int w_limit) {
+  distfork_ctx_t * const ctx = warg->ctx;
+  const csr_t * const mH = ctx->p->spaH;
+  const one_vec_t * const sy = warg->syn[d];
+  if ((d + 1 >= cc_limit(ctx, w_limit)) && cc_swei_done(warg, d, sy->wei, d + 1)) {
+    cc_coltab_find(ctx, sy, &warg->fr[d]);
+    return;
+  }
+  if (ctx->p->ccbranch) {
+    cc_branch(warg, sy, warg->urr->vec[0], warg->err->vec, d, &warg->fr[d]);
+    return;
+  }
+  const int row = sy->vec[0];
+  warg->fr[d].list = mH->i;
+  warg->fr[d].i = mH->p[row];
+  warg->fr[d].end = mH->p[row+1];
+}
+
+/** @brief if this thread has nothing queued, queue the remaining
+    branches of the lowest level `d0...d` below `CC_SPLIT_DEPTH`; return 1 if any */
+static int cc_split(worker_arg_t *warg, const int d0, const int d, const int w_limit) {
+  distfork_ctx_t *ctx = warg->ctx;
+  cc_deque_t * const dq = &ctx->cc_dq[warg->tid];
+  if (atomic_load_explicit(&dq->num, memory_order_relaxed))
+    return 0;
+  for (int l = d0; (l <= d) && (l < CC_SPLIT_DEPTH) && (l + 1 < w_limit); l++) {
+    cc_frame_t * const f = &warg->fr[l];
+    if (f->i < f->end) {
+      cc_deque_push(ctx, dq, w_limit, warg->urr->vec, l, f->list + f->i, f->end - f->i);
+      f->i = f->end;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief CC search of all clusters up to weight `w_limit` extending
+ * `err` (weight `d0`, non-zero syndrome `syn[d0]`), depth first with
+ * an explicit stack.  While other CC threads wait for work, the
+ * remaining branches of the lowest levels are moved to this thread's
+ * deque.  On return `err` is restored.
+ * @return 1 if the search is to be stopped, 0 otherwise.
+ */
+static int cc_search(worker_arg_t *warg, const int w_limit) {
+  distfork_ctx_t *ctx = warg->ctx;
+  one_vec_t * const err = warg->err, * const urr = warg->urr;
+  cc_frame_t * const fr = warg->fr;
+  const atomic_bool * const stop = &ctx->cc_rd[w_limit & 1].stop;
+  const int d0 = err->wei;
+  int d = d0, ret = 0;
+  cc_frame_open(warg, d, w_limit);
+  while (!atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed) &&
+         !atomic_load_explicit(stop, memory_order_relaxed)) {
+    if (fr[d].i == fr[d].end) {
+      if (d == d0)
+        break;
+      d--;
+      urr->wei--;
+      one_ordered_pos_del(err, fr[d].col, fr[d].pos);
+      continue;
+    }
+    if ((atomic_load_explicit(&ctx->cc_hungry, memory_order_relaxed) > 0) && cc_split(warg, d0, d, w_limit))
+      continue;
+    const int res = cc_add_col(warg, fr[d].list[fr[d].i++], w_limit);
+    if (res < 0) {
+      ret = 1;
+      break;
+    }
+    if (res > 0)
+      cc_frame_open(warg, ++d, w_limit);
+  }
+  for (; d > d0; d--) {
+    urr->wei--;
+    one_ordered_pos_del(err, fr[d-1].col, fr[d-1].pos);
+  }
+  return ret;
+}
+
+/** @brief search a queued CC subtree, unless its round has been stopped */
+static void cc_run_task(worker_arg_t *warg, const cc_task_t * const t) {
+  distfork_ctx_t *ctx = warg->ctx;
+  one_vec_t * const err = warg->err, * const urr = warg->urr;
+  const int w_limit = t->w;
+  if (atomic_load(&ctx->cc_rd[w_limit & 1].stop))
+    return;
+  /** the columns before the last one were checked by the thread that queued the task */
+  err->vec[0] = urr->vec[0] = t->col[0];
+  err->wei = urr->wei = 1;
+  for (int l = 0; l + 1 < t->len; l++) {
+    if (l) {
+      urr->vec[l] = t->col[l];
+      urr->wei++;
+      one_ordered_ins(err, t->col[l]);
+    }
+    warg->syn[l+1]->wei = 0;
+    one_csr_row_combine(warg->syn[l+1], warg->syn[l], ctx->mHT_cc, t->col[l]);
+  }
+  if (cc_add_col(warg, t->col[t->len - 1], w_limit) > 0)
+    cc_search(warg, w_limit);
+  err->wei = urr->wei = 0;
+}
+
+/** @brief take a CC subtree, own ones first; return 1 on success */
+static int cc_task_get(distfork_ctx_t *ctx, const int tid, cc_task_t *t) {
+  if (cc_deque_take(&ctx->cc_dq[tid], t, true))
+    return 1;
+  for (int k = 1; k < ctx->num_threads; k++)
+    if (cc_deque_take(&ctx->cc_dq[(tid + k) % ctx->num_threads], t, false))
+      return 1;
+  return 0;
+}
+
+/** @brief CC search of all clusters of weight up to `w` starting with column `col` */
+static void cc_run_col(worker_arg_t *warg, const int col, const int w) {
+  distfork_ctx_t *ctx = warg->ctx;
+  one_vec_t * const err = warg->err, * const urr = warg->urr;
+  one_vec_t * const * const syn = warg->syn;
+  err->vec[0] = urr->vec[0] = col;
+  err->wei = urr->wei = 1;
+  syn[1]->wei = 0;
+  int swei = one_csr_row_combine(syn[1], syn[0], ctx->mHT_cc, col);
+
+  if (ctx->p->smax && swei > 0 && swei <= ctx->p->smax) {
+    if (swei < warg->min_swei[1]) {
+      warg->min_swei[1] = swei;
+    }
+  }
+
+  if (swei) {
+    if (w > 1)
+      cc_search(warg, w);
+  } else if ((w == 1) || ctx->p->ccpass) {
+    int nz = (!ctx->p->spaL) || colmask_syndrome_non_zero(ctx->p->maskL, 1, err->vec);
+    if (nz) {
+      codeword_add_maybe(ctx->p, err->vec, 1);
+      atomic_store(&ctx->cc_found_weight, 1);
+      atomic_store(&ctx->dmin, 1);
+      atomic_store(&ctx->dmax, 1);
+      ctx_stop(ctx);
+    }
+  }
+  err->wei = urr->wei = 0;
+}
+
+/* Run RW batch */
+/**
+ * Move to an adjacent information set (Canteaut-Chabaud): a random
+ * non-pivot column `c` replaces the pivot of a random row `i` with
+ * `H[i,c]=1`.  One pivot operation done directly on the dual rows
+ * `mG`, i.e., `mG[q] ^= mG[ic]-e_i` for each `q` with bit `i` set;
+ * row `ic` is unchanged and becomes the dual row of the old pivot
+ * column.  `rows` is a scratch array of size at least `rank`.
+ * @return 1 on success, 0 if no suitable column was found.
+ */
+static int rw_swap_pivot(bmat_t *mG, mzp_t *pivs, mzp_t *skip_pivs, const int rank,
+                         int *rows, uint64_t *rng_state) {
+  const int k = skip_pivs->length;
+  if (rank == 0 || k == 0) return 0;
+  for (int tries = 0; tries < 8; tries++) {
+    const int ic = rand_uniform_thread(k, rng_state);
+    const int c = skip_pivs->values[ic];
+    const word * const rowc = bmat_row(mG, ic);
+    int num = 0;
+    for (rci_t j = nextelement(rowc, mG->width, 0); j != -1 && j < rank;
+         j = nextelement(rowc, mG->width, j + 1))
+      rows[num++] = j;
+    if (num == 0) continue; /** zero column */
+    const int i = rows[rand_uniform_thread(num, rng_state)];
+    const wi_t blk = SETWD(i);
+    const word bit = m4ri_one << SETBT(i);
+    for (int q = 0; q < k; q++) {
+      word * const rowq = bmat_row(mG, q);
+      if ((q != ic) && (rowq[blk] & bit)) {
+        bmat_xor(rowq, rowc, mG->width);
+        rowq[blk] ^= bit; /** `rowc` still has bit `i` */
+      }
+    }
+    skip_pivs->values[ic] = pivs->values[i];
+    pivs->values[i] = c;
+    return 1;
+  }
+  return 0;
+}
+
+/* Thread-local RW work space, allocated in the thread's own arena */
+typedef struct {
+  bmat_arena_t *arena; /* owns everything below except `sp` */
+  bmat_t *mH;          /* `H` with permuted columns, reduced */
+  bmat_t *mG;          /* dual rows: row `ic` is column `skip_pivs[ic]` of reduced `mH` */
+  int mG_all;          /* all `k` dual rows are kept (`lb`, `isd`, `rwinc`, group); else blocks of 64 */
+  bmat_par_t *par;     /* parallel loops of the thread's RW group, NULL if none */
+  rci_t *ee;           /* codeword support, and scratch for sorting it; one per group thread */
+  word *lacc;          /* scratch for the `L` syndrome, `maskL` width; one per group thread */
+  mzp_t *perm;         /* random column permutation */
+  mzp_t *pivs;         /* pivot (permuted) column of each row */
+  mzp_t *pivs_srtd;    /* inverse permutation */
+  mzp_t *skip_pivs;    /* non-pivot (permuted) columns */
+  word *tab;           /* work space for `bmat_echelon()` */
+  spgauss_t *sp;       /* sparse elimination (`rwsparse`), NULL for dense */
+  long long sp_max_nz; /* fall back to dense `mH` above this fill */
+  int rw_inc;          /* incremental RW steps since the last full elimination */
+  /* Stern collision search, only with `isd=stern` */
+  int *isd_head;       /* `2^isdl` bucket heads */
+  int *isd_next;       /* bucket chains, one per left subset */
+  int *isd_subs;       /* `isdp` column positions per left subset */
+  word *isd_sum;       /* scratch row of `mG` width */
+  /* Lee-Brickell combinations, only with `lb>1` */
+  word *lb_sum;        /* partial sums, `lb` rows of `mG` width */
+  int *lb_idx;         /* non-pivot column positions on each level */
+} rw_work_t;
+
+/** max number of `isdp`-subsets on each side in Stern's algorithm */
+#define ISD_MAX_LIST (1 << 18)
+/** max automatic window size `isdl` */
+#define ISD_AUTO_L 18
+/** max number of collisions checked per information set; with
+    sparse `H` many columns vanish on the window and collide */
+#define ISD_MAX_COLL (4 * ISD_MAX_LIST)
+/** with `rwsparse=-1`, use sparse elimination if dense `mH` takes more bytes */
+#define RW_SPARSE_AUTO_BYTES (1LL << 26)
+/** shares of the memory budget for RW work space and for the codeword store */
+#define MEM_RW_SHARE 0.5
+#define MEM_CW_SHARE 0.25
+#define MEM_CC_SHARE 0.25
+/** bytes of a stored codeword of weight `w`, with index slots at the lowest load */
+#define CW_BYTES(w) ((long long) (sizeof(cw_vec_t) + sizeof(int) * (w) + 4 * sizeof(cw_slot_t)))
+
+static void rw_work_init(rw_work_t *rw, const params_t * const p, bmat_par_t * const par) {
+  const int nvar = p->spaH->cols, nthr = par ? par->nthreads : 1;
+  const long long dense_bytes = (long long) p->spaH->rows * ((nvar + 511) / 512) * 64;
+  bmat_arena_t * const A = rw->arena = bmat_arena_init();
+  rw->par = par;
+  /** a group shares one dense elimination */
+  if ((!par) && ((p->rwsparse == 1) || ((p->rwsparse < 0) && (dense_bytes > RW_SPARSE_AUTO_BYTES)))) {
+    rw->sp = spgauss_init(p->spaH);
+    rw->sp_max_nz = (long long) p->spaH->rows * nvar / SPGAUSS_FILL;
+    rw->mH = NULL; /** only allocated if the fill gets too large */
+    rw->tab = NULL;
+  } else {
+    rw->sp = NULL;
+    rw->mH = bmat_init_arena(A, p->spaH->rows, nvar);
+    rw->tab = bmat_echelon_tab(rw->mH);
+  }
+  /** with all dual rows, `mG` is resized after the first elimination */
+  rw->mG_all = (p->lb > 1) || p->isd || (p->rwinc > 0) || (par != NULL);
+  rw->mG = bmat_init_arena(A, 64, p->spaH->rows);
+  rw->ee = bmat_arena_alloc(A, nthr * 2 * (nvar + 2) * sizeof(rci_t));
+  rw->lacc = bmat_arena_alloc(A, nthr * sizeof(word) * (p->maskL ? p->maskL->width : 1));
+  rw->perm = bmat_arena_perm(A, nvar);
+  rw->pivs = bmat_arena_perm(A, nvar);
+  rw->pivs_srtd = bmat_arena_perm(A, nvar);
+  rw->skip_pivs = bmat_arena_perm(A, nvar);
+  rw->rw_inc = 0;
+  if (p->isd) {
+    const int l = p->isdl > 0 ? p->isdl : ISD_AUTO_L;
+    rw->isd_head = bmat_arena_alloc(A, sizeof(int) << l);
+    rw->isd_next = bmat_arena_alloc(A, sizeof(int) * ISD_MAX_LIST);
+    rw->isd_subs = bmat_arena_alloc(A, sizeof(int) * ISD_MAX_LIST * p->isdp);
+    rw->isd_sum = bmat_arena_alloc(A, sizeof(word) * (rw->mG->width + 1));
+  }
+  if (p->lb > 1) {
+    rw->lb_sum = bmat_arena_alloc(A, sizeof(word) * p->lb * (rw->mG->width + 1));
+    rw->lb_idx = bmat_arena_alloc(A, sizeof(int) * p->lb);
+  }
+}
+
+static void rw_work_free(rw_work_t *rw) {
+  spgauss_free(rw->sp);
+  rw->arena = bmat_arena_free(rw->arena);
+}
+
+/** @brief bytes taken by `rw_work_init()` and the elimination: `mH`
+    and `mG` (up to `r` rows of length `n`), the Stern lists, and one
+    unused arena block */
+static long long rw_work_bytes(const params_t * const p) {
   const int nvar = p->spaH->cols;
-  const int classical = p->classical;
+  long long bytes = 2LL * p->spaH->rows * ((nvar + 511) / 512) * 64;
+  bytes += 10LL * (nvar + 2) * sizeof(rci_t) + BMAT_ARENA_BLK;
+  if (p->isd) {
+    const int l = p->isdl > 0 ? p->isdl : ISD_AUTO_L;
+    bytes += (long long) (sizeof(int) << l) + (long long) sizeof(int) * ISD_MAX_LIST * (p->isdp + 1);
+  }
+  return bytes;
+}
 
-  for (int step = 0; step < n_steps; step++) {
-    if (atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed)) break;
+/**
+ * @brief RW group (`rwgroup`): threads `leader...leader+par.nthreads-1`
+ * share the leader's work space.  The leader posts each parallel loop
+ * of an RW step as a job, and takes the chunks no other thread took;
+ * the other threads take chunks while the leader runs RW steps, so
+ * that the leader never waits for a thread busy elsewhere.  The job
+ * number is kept in the high bits of `next`, so that a chunk can only
+ * be taken from the current job.
+ */
+typedef struct RW_GROUP_T {
+  bmat_par_t par;             /* `par.run()` posts a job, must be first */
+  int leader;
+  atomic_bool busy;           /* the leader is running RW steps */
+  atomic_llong next;          /* job number `<<32`, and its next chunk */
+  _Atomic(bmat_par_fn) fun;   /* the current job */
+  _Atomic(void *) arg;
+  atomic_int num, chunk, nchunk;
+  atomic_int done;            /* chunks of the current job finished */
+} rw_group_t;
+
+/** @brief run a chunk of the current job as thread `id` of the group, 0 if none left */
+static int rw_group_chunk(rw_group_t * const g, const int id) {
+  long long cur = atomic_load(&g->next);
+  bmat_par_fn fun;
+  void *arg;
+  int num, chunk;
+  do {
+    /** only used if the job did not change, see the `CAS` */
+    fun = atomic_load_explicit(&g->fun, memory_order_relaxed);
+    arg = atomic_load_explicit(&g->arg, memory_order_relaxed);
+    num = atomic_load_explicit(&g->num, memory_order_relaxed);
+    chunk = atomic_load_explicit(&g->chunk, memory_order_relaxed);
+    if ((int) (cur & 0xffffffff) >= atomic_load_explicit(&g->nchunk, memory_order_relaxed))
+      return 0;
+  } while (!atomic_compare_exchange_weak(&g->next, &cur, cur + 1));
+  const int beg = (int) (cur & 0xffffffff) * chunk;
+  fun(arg, beg, minint(num, beg + chunk), id);
+  atomic_fetch_add(&g->done, 1);
+  return 1;
+}
+
+/** @brief `bmat_par_t::run()` of the group, called by the leader */
+static void rw_group_run(bmat_par_t *par, bmat_par_fn fun, void *arg, const int num, const int chunk) {
+  rw_group_t * const g = (rw_group_t *) par;
+  const int nchunk = (num + chunk - 1) / chunk;
+  if (nchunk <= 1) {
+    if (num > 0)
+      fun(arg, 0, num, 0);
+    return;
+  }
+  atomic_store_explicit(&g->fun, fun, memory_order_relaxed);
+  atomic_store_explicit(&g->arg, arg, memory_order_relaxed);
+  atomic_store_explicit(&g->num, num, memory_order_relaxed);
+  atomic_store_explicit(&g->chunk, chunk, memory_order_relaxed);
+  atomic_store_explicit(&g->nchunk, nchunk, memory_order_relaxed);
+  atomic_store_explicit(&g->done, 0, memory_order_relaxed);
+  atomic_store(&g->next, ((atomic_load(&g->next) >> 32) + 1) << 32);
+  while (rw_group_chunk(g, 0)) {}
+  while (atomic_load(&g->done) < nchunk)
+    sched_yield();
+}
 
-    pivs = mzp_rand_thread(pivs, nvar, rng_state);
-    mzp_set_ui(perm, 1);
-    perm = perm_p_trans(perm, pivs, 0);
+/** @brief as thread `id` of the group, help the leader until it stops
+    running RW steps, or an event after `seq = ctx_event()` */
+static void rw_group_help(distfork_ctx_t *ctx, rw_group_t * const g, const int id, const unsigned long seq) {
+  while (atomic_load(&g->busy) && (ctx_event(ctx) == seq))
+    if (!rw_group_chunk(g, id))
+      sched_yield();
+}
+
+/** @brief RW codewords of weight `>=` this are of no interest */
+static inline int rw_limit(distfork_ctx_t *ctx, const int nvar) {
+  const params_t * const p = ctx->p;
+  int limit = nvar + 1;
+  int cur_dmax = atomic_load_explicit(&ctx->dmax, memory_order_relaxed);
+  if (cur_dmax > 0) {
+    if ((p->outC || p->maxC || p->dW > 0) && p->dW >= 0) {
+      limit = minint(limit, cur_dmax + p->dW + 1);
+    } else {
+      limit = minint(limit, cur_dmax);
+    }
+  }
+  return limit;
+}
 
-    int rank = 0;
-    for (int i = 0; i < nvar; i++) {
-      int col = perm->values[i];
-      int ret = gauss_one(mH, col, rank);
-      if (ret) {
-        pivs->values[rank++] = col;
+/** @brief sort `ee[0...cnt-1]` and store a codeword known to be non-trivial;
+    `ee[cnt...2*cnt-1]` is used as scratch */
+static void rw_store_cw(distfork_ctx_t *ctx, rci_t *ee, const int cnt, const int tid, const char *who) {
+  params_t * const p = ctx->p;
+  sort_rci_t(ee, cnt, ee + cnt);
+  codeword_add_maybe(p, ee, cnt);
+  atomic_min_int(&p->min_w, cnt);
+  const int best = atomic_load(&p->min_w);
+  if (atomic_min_nz(&ctx->dmax, best)) {
+    if (p->debug & 16) {
+      int num_rw = (ctx->p->method == 1) ? ctx->num_threads : (ctx->num_threads - atomic_load(&ctx->cc_target_workers));
+      if (num_rw < 1) num_rw = 1;
+      fprintf(stderr, "# [thread %d] %s found new upper bound cw of weight %d (using %d RW threads)\n", tid, who, best, num_rw);
+    }
+    int cur_dmin = atomic_load(&ctx->dmin);
+    if (cur_dmin > 0 && best <= cur_dmin) {
+      ctx_stop(ctx);
+    }
+  }
+  if (p->wmin > 0 && best <= p->wmin) {
+    ctx_stop(ctx);
+  }
+  if (p->maxC && p->num_cws >= p->maxC) {
+    ctx_stop(ctx);
+  }
+}
+
+/** @brief check `ee[0...cnt-1]` against `L`, and store a non-trivial codeword */
+static void rw_add_cw(distfork_ctx_t *ctx, rci_t *ee, const int cnt, const int tid, const char *who) {
+  const params_t * const p = ctx->p;
+  if ((!p->maskL) || colmask_syndrome_non_zero(p->maskL, cnt, ee))
+    rw_store_cw(ctx, ee, cnt, tid, who);
+}
+
+/**
+ * @brief Logical check for a block of up to 64 dual rows at once.
+ *
+ * Dual row `ir` (bits over pivots) of `mG`, starting with row `row0`,
+ * is the codeword with support `cols[ir]` and `pivs[j]` for each set
+ * bit `j`; its `L` syndrome is the `XOR` of the corresponding column
+ * masks of `L`.  `acc` is scratch space of `L` mask width.
+ * @return the bits of `cand` for the rows with a non-zero syndrome.
+ */
+static word rw_logical_block(const csr_colmask_t * const M, const bmat_t * const mG, const int row0,
+                             word cand, const rci_t * const cols, const rci_t * const perm,
+                             const rci_t * const pivs, const int rwords, word * const acc) {
+  const int width = M->width;
+  word res = 0;
+  while (cand) {
+    const int ir = FIRSTBIT(cand);
+    cand &= cand - 1;
+    const word * const row = bmat_row(mG, row0 + ir);
+    memcpy(acc, M->mask + (size_t) perm[cols[ir]] * width, sizeof(word) * width);
+    for (int w = 0; w < rwords; w++) {
+      for (word bits = row[w]; bits; bits &= bits - 1) {
+        const word * const lp = M->mask + (size_t) perm[pivs[w * m4ri_radix + FIRSTBIT(bits)]] * width;
+        for (int i = 0; i < width; i++)
+          acc[i] ^= lp[i];
       }
     }
+    for (int i = 0; i < width; i++)
+      if (acc[i]) {
+        res |= m4ri_one << ir;
+        break;
+      }
+  }
+  return res;
+}
+
+/** @brief next `np`-subset `c[0]<c[1]<...` of `{0,...,n-1}` in lex order; 0 if none */
+static inline int comb_next(int *c, const int np, const int n) {
+  int i = np - 1;
+  while (i >= 0 && c[i] == n - np + i) i--;
+  if (i < 0) return 0;
+  c[i]++;
+  for (int j = i + 1; j < np; j++) c[j] = c[j - 1] + 1;
+  return 1;
+}
 
-    pivs_srtd = mzp_copy(pivs_srtd, pivs);
-    qsort(pivs_srtd->values, rank, sizeof(pivs->values[0]), cmp_rci_t);
-    int end = -1, num = 0;
-    for (int i = 0; i < rank; i++) {
-      int beg = end + 1;
-      end = pivs_srtd->values[i];
-      for (int j = beg; j < end; j++) {
-        skip_pivs->values[num++] = j;
+/**
+ * Stern's collision search in the current information set.  The
+ * first `2*k1` non-pivot columns are split in two halves; the sums of
+ * dual rows over `isdp`-subsets of the left half are hashed by
+ * `isdl` bits starting at a random row `off`.  Every `isdp`-subset of
+ * the right half with a matching key gives a codeword which vanishes
+ * on the window; its full weight is checked against the RW limit.
+ */
+static void run_isd_stern(distfork_ctx_t *ctx, rw_work_t *rw, const int rank,
+                          uint64_t *rng_state, int tid) {
+  const params_t * const p = ctx->p;
+  const int nvar = p->spaH->cols;
+  const bmat_t * const mG = rw->mG;
+  const int width = mG->width;
+  const rci_t * const cols = rw->skip_pivs->values;
+  const rci_t * const perm = rw->perm->values;
+  const rci_t * const pivs = rw->pivs->values;
+  const int k = rw->skip_pivs->length;
+  const int np = p->isdp;
+
+  /** largest `k1` with `binom(k1,np) <= ISD_MAX_LIST` */
+  int k1 = np - 1;
+  double nsub = 0;
+  while (2 * (k1 + 1) <= k) {
+    double b = 1;
+    for (int i = 0; i < np; i++)
+      b = b * (k1 + 1 - i) / (i + 1);
+    if (b > ISD_MAX_LIST) break;
+    nsub = b;
+    k1++;
+  }
+  if (k1 < np || rank == 0) return;
+
+  int l = p->isdl;
+  if (l == 0) { /** about one left entry per bucket */
+    l = 1;
+    while ((l < ISD_AUTO_L) && ((double) (1 << l) < nsub)) l++;
+  }
+  if (l > rank) l = rank;
+  const rci_t off = rand_uniform_thread(rank - l + 1, rng_state);
+  int * const head = rw->isd_head, * const next = rw->isd_next, * const subs = rw->isd_subs;
+  for (int i = 0; i < (1 << l); i++) head[i] = -1;
+
+  int c[ISD_MAX_P];
+  int num = 0;
+  for (int i = 0; i < np; i++) c[i] = i;
+  do {
+    word key = 0;
+    for (int i = 0; i < np; i++)
+      key ^= bmat_read_bits(mG, c[i], off, l);
+    for (int i = 0; i < np; i++)
+      subs[num * np + i] = c[i];
+    next[num] = head[key];
+    head[key] = num++;
+  } while (comb_next(c, np, k1));
+
+  word * const sum = rw->isd_sum;
+  long iter = 0, ncoll = 0;
+  for (int i = 0; i < np; i++) c[i] = i;
+  do {
+    if (((++iter & 1023) == 0) && atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed))
+      break;
+    word key = 0;
+    for (int i = 0; i < np; i++)
+      key ^= bmat_read_bits(mG, k1 + c[i], off, l);
+    for (int e = head[key]; e != -1; e = next[e]) {
+      if (++ncoll > ISD_MAX_COLL) return;
+      const int limit = rw_limit(ctx, nvar);
+      if (2 * np >= limit) return; /** nothing of interest */
+      const int * const a = subs + e * np;
+      bmat_xor3(sum, bmat_row(mG, a[0]), bmat_row(mG, k1 + c[0]), width);
+      for (int i = 1; i < np; i++) {
+        bmat_xor(sum, bmat_row(mG, a[i]), width);
+        bmat_xor(sum, bmat_row(mG, k1 + c[i]), width);
+      }
+      int wt = 2 * np;
+      for (int j = 0; (j < width) && (wt < limit); j++)
+        wt += m4ri_bitcount(sum[j]);
+      if (wt < limit) {
+        int cnt = 0;
+        for (int i = 0; i < np; i++) {
+          rw->ee[cnt++] = perm[cols[a[i]]];
+          rw->ee[cnt++] = perm[cols[k1 + c[i]]];
+        }
+        for (rci_t j = nextelement(sum, width, 0); j != -1; j = nextelement(sum, width, j + 1))
+          rw->ee[cnt++] = perm[pivs[j]];
+        rw_add_cw(ctx, rw->ee, cnt, tid, "RW");
       }
     }
-    for (int j = end + 1; j < nvar; j++) {
-      skip_pivs->values[num++] = j;
+  } while (comb_next(c, np, k1));
+}
+
+/**
+ * Lee-Brickell: sums of `2...lb` distinct dual rows (one per non-pivot
+ * column) of the current information set.  Combinations are
+ * enumerated depth-first, with the partial sum of dual rows kept for
+ * each level, so every combination costs one row `XOR` and popcount.
+ */
+static void run_lee_brickell(distfork_ctx_t *ctx, rw_work_t *rw, const int rank, int tid) {
+  const params_t * const p = ctx->p;
+  const int nvar = p->spaH->cols;
+  const bmat_t * const mG = rw->mG;
+  const int width = mG->width;
+  const rci_t * const cols = rw->skip_pivs->values;
+  const rci_t * const perm = rw->perm->values;
+  const rci_t * const pivs = rw->pivs->values;
+  const int k = rw->skip_pivs->length;
+  const int np = p->lb;
+  int * const idx = rw->lb_idx;
+  if (k < 2 || rank == 0) return;
+
+  long iter = 0;
+  int lev = 0;
+  idx[0] = 0;
+  while (lev >= 0) {
+    if (idx[lev] >= k) { /** done with this level */
+      if (--lev >= 0) idx[lev]++;
+      continue;
+    }
+    if (((++iter & 1023) == 0) && atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed))
+      return;
+    const int limit = rw_limit(ctx, nvar);
+    if (limit <= 2) return; /** nothing of interest */
+    const word * const row = bmat_row(mG, idx[lev]);
+    word * const sum = rw->lb_sum + lev * width;
+    if (lev == 0) {
+      for (int j = 0; j < width; j++) sum[j] = row[j];
+    } else {
+      bmat_xor3(sum, sum - width, row, width);
+      int wt = lev + 1;
+      for (int j = 0; j < width; j++)
+        wt += m4ri_bitcount(sum[j]);
+      if (wt < limit) {
+        int cnt = 0;
+        for (int i = 0; i <= lev; i++)
+          rw->ee[cnt++] = perm[cols[idx[i]]];
+        for (rci_t j = nextelement(sum, width, 0); j != -1; j = nextelement(sum, width, j + 1))
+          rw->ee[cnt++] = perm[pivs[j]];
+        rw_add_cw(ctx, rw->ee, cnt, tid, "RW");
+      }
     }
-    skip_pivs->length = num;
+    if ((lev + 1 < np) && (lev + 2 < limit) && (idx[lev] + 1 < k)) {
+      idx[lev + 1] = idx[lev] + 1;
+      lev++;
+    } else {
+      idx[lev]++;
+    }
+  }
+}
 
-    mzd_transpose(mHT, mH);
+/** @brief rows `0...num-1` of `mG` set to the dual rows of non-pivot columns `cols[]` */
+static void rw_dual_rows(rw_work_t *rw, const rci_t * const cols, const int num) {
+  if (rw->sp) { /** back substitution in the sparse echelon form */
+    for (int ic = 0; ic < num; ic++)
+      spgauss_dual_row(rw->sp, cols[ic], bmat_row(rw->mG, ic), rw->mG->width);
+  }
+  else
+    bmat_gather_cols_par(rw->mG, rw->mH, cols, num, rw->par);
+}
 
-    int k = nvar - rank;
-    for (int ir = 0; ir < k; ir++) {
-      int cnt = 0;
-      const int col = ee[cnt++] = skip_pivs->values[ir];
-      int limit = nvar + 1;
-      int cur_dmax = atomic_load_explicit(&ctx->dmax, memory_order_relaxed);
-      if (cur_dmax > 0) {
-        if ((p->outC || p->maxC || p->dW > 0) && p->dW >= 0) {
-          limit = minint(limit, cur_dmax + p->dW + 1);
-        } else {
-          limit = minint(limit, cur_dmax);
+/** @brief dual rows `beg...beg+num-1` of the step, `num<=64`, from row
+    `row0` of `mG`; rows light enough are checked against `L` together,
+    and the codewords stored, with the scratch `ee` and `lacc` */
+static void rw_check_rows(distfork_ctx_t *ctx, const rw_work_t *rw, const int beg, const int num,
+                          const int row0, const int rank, rci_t * const ee, word * const lacc, const int tid) {
+  const params_t * const p = ctx->p;
+  const int nvar = p->spaH->cols, rwords = (rank + m4ri_radix - 1) / m4ri_radix;
+  const rci_t * const perm = rw->perm->values, * const pivs = rw->pivs->values;
+  const rci_t * const skip = rw->skip_pivs->values;
+  const int limit = rw_limit(ctx, nvar);
+  word cand = 0;
+  for (int ir = 0; ir < num; ir++) {
+    const word * const row = bmat_row(rw->mG, row0 + ir);
+    int wt = 1; /** check the weight before listing the support */
+    for (int j = 0; (j < rwords) && (wt < limit); j++)
+      wt += m4ri_bitcount(row[j]);
+    if (wt < limit)
+      cand |= m4ri_one << ir;
+  }
+  if (cand && p->maskL)
+    cand = rw_logical_block(p->maskL, rw->mG, row0, cand, skip + beg, perm, pivs, rwords, lacc);
+  for (; cand; cand &= cand - 1) {
+    const int ir = FIRSTBIT(cand);
+    const word * const row = bmat_row(rw->mG, row0 + ir);
+    int cnt = 0;
+    ee[cnt++] = perm[skip[beg + ir]];
+    for (rci_t j = nextelement(row, rwords, 0); j != -1; j = nextelement(row, rwords, j + 1))
+      ee[cnt++] = perm[pivs[j]];
+    rw_store_cw(ctx, ee, cnt, tid, "RW");
+  }
+}
+
+typedef struct {
+  distfork_ctx_t *ctx;
+  const rw_work_t *rw;
+  int rank, k, tid;
+} rw_check_arg_t;
+
+/** blocks of 64 dual rows checked per chunk in an RW group */
+#define RW_PAR_BLOCKS 4
+
+/** @brief `rw_check_rows()` for blocks `first...last-1` of all `k` dual
+    rows in `mG`, as thread `id` of the RW group */
+static void rw_check_blocks(void *arg, const int first, const int last, const int id) {
+  const rw_check_arg_t * const a = arg;
+  const params_t * const p = a->ctx->p;
+  rci_t * const ee = a->rw->ee + (size_t) id * 2 * (p->spaH->cols + 2);
+  word * const lacc = a->rw->lacc + (size_t) id * (p->maskL ? p->maskL->width : 1);
+  for (int b = first; b < last; b++)
+    rw_check_rows(a->ctx, a->rw, 64 * b, minint(64, a->k - 64 * b), 64 * b, a->rank, ee, lacc, a->tid + id);
+}
+
+static void run_rw_steps(distfork_ctx_t *ctx, int n_steps, rw_work_t *rw,
+                         uint64_t *rng_state, int tid) {
+  params_t * const p = ctx->p;
+  const int nvar = p->spaH->cols;
+  mzp_t * const perm = rw->perm, * const pivs = rw->pivs, * const skip_pivs = rw->skip_pivs;
+  rci_t * const ee = rw->ee;
+
+  for (int step = 0; step < n_steps; step++) {
+    if (atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed)) break;
+
+    int rank;
+    if (p->rwinc > 0 && rw->rw_inc > 0) {
+      /** incremental step: `rwinc` pivot swaps on `mG`, `pivs` is indexed by row */
+      rank = nvar - skip_pivs->length;
+      for (int i = 0; i < p->rwinc; i++)
+        rw_swap_pivot(rw->mG, pivs, skip_pivs, rank, ee, rng_state);
+      if (++rw->rw_inc >= nvar)
+        rw->rw_inc = 0; /** fresh random information set next time */
+    }
+    else {
+      mzp_rand_thread(pivs, nvar, rng_state);
+      mzp_set_ui(perm, 1);
+      perm_p_trans(perm, pivs, 0);
+      /** `pivs_srtd` holds the inverse permutation here */
+      for (int i = 0; i < nvar; i++)
+        rw->pivs_srtd->values[perm->values[i]] = i;
+
+      /** columns in the order `perm`, pivots are in permuted positions */
+      rank = -1;
+      if (rw->sp) {
+        rank = spgauss_echelon(rw->sp, p->spaH, rw->pivs_srtd, pivs, rw->sp_max_nz);
+        if (rank < 0) { /** too much fill, dense from now on */
+          if (p->debug & 2)
+            fprintf(stderr, "# [thread %d] RW: sparse fill above %lld, switching to dense elimination\n",
+                    tid, rw->sp_max_nz);
+          rw->sp = spgauss_free(rw->sp);
+          rw->mH = bmat_init_arena(rw->arena, p->spaH->rows, nvar);
+          rw->tab = bmat_echelon_tab(rw->mH);
         }
       }
+      if (rank < 0) {
+        bmat_from_csr_perm(rw->mH, p->spaH, rw->pivs_srtd);
+        rank = bmat_echelon_par(rw->mH, pivs, rw->tab, rw->par);
+      }
 
-      word *rawrow = mzd_row(mHT, col);
-      rci_t j = -1;
-      while (cnt < limit) {
-        j = nextelement(rawrow, mHT->width, j);
-        if (j == -1 || j >= rank) break;
-        ee[cnt++] = pivs->values[j++];
+      /** pivots are increasing, the rest are skipped */
+      int num = 0;
+      for (int i = 0, q = 0; q < nvar; q++) {
+        if (i < rank && pivs->values[i] == q)
+          i++;
+        else
+          skip_pivs->values[num++] = q;
       }
+      skip_pivs->length = num;
+      if (p->rwinc > 0)
+        rw->rw_inc = 1;
 
-      if (cnt < limit) {
-        qsort(ee, cnt, sizeof(rci_t), cmp_rci_t);
-        int nz = classical ? 1 : sparse_syndrome_non_zero(spaL0, cnt, ee);
-        if (nz) {
-          pthread_mutex_lock(&ctx->cw_mutex);
-          p->codewords = codeword_add_maybe(p, ee, cnt);
-          if (cnt < p->min_w) p->min_w = cnt;
-          int best = p->min_w;
-          int old_dmax = atomic_load(&ctx->dmax);
-          if (old_dmax == 0 || best < old_dmax) {
-            atomic_store(&ctx->dmax, best);
-            if (p->debug & 16) {
-              int num_rw = (ctx->p->method == 1) ? ctx->num_threads : (ctx->num_threads - atomic_load(&ctx->cc_target_workers));
-              if (num_rw < 1) num_rw = 1;
-              fprintf(stderr, "# [thread %d] RW found new upper bound cw of weight %d (using %d RW threads)\n", tid, best, num_rw);
-            }
-            int cur_dmin = atomic_load(&ctx->dmin);
-            if (cur_dmin > 0 && best <= cur_dmin) {
-              atomic_store(&ctx->stop_flag, true);
-            }
-          }
-          if (p->wmin > 0 && best <= p->wmin) {
-            atomic_store(&ctx->stop_flag, true);
-          }
-          if (p->maxC && p->num_cws >= p->maxC) {
-            atomic_store(&ctx->stop_flag, true);
-          }
-          pthread_mutex_unlock(&ctx->cw_mutex);
+      if (rw->mG_all) { /** dual rows of all non-pivot columns */
+        if (rw->mG->nrows < num) {
+          rw->mG = bmat_init_arena(rw->arena, num, p->spaH->rows);
         }
+        rw_dual_rows(rw, skip_pivs->values, num);
       }
     }
-    atomic_fetch_add(&ctx->rw_steps_completed, 1);
+
+    /** dual rows from `mG`, filled here in blocks of 64 unless `mG_all` */
+    const int k = nvar - rank;
+    if (rw->par) {
+      rw_check_arg_t a = {ctx, rw, rank, k, tid};
+      bmat_par_run(rw->par, rw_check_blocks, &a, (k + 63) / 64, RW_PAR_BLOCKS);
+    }
+    else
+      for (int beg = 0; beg < k; beg += 64) {
+        const int num = minint(64, k - beg);
+        if (!rw->mG_all)
+          rw_dual_rows(rw, skip_pivs->values + beg, num);
+        rw_check_rows(ctx, rw, beg, num, rw->mG_all ? beg : 0, rank, ee, rw->lacc, tid);
+      }
+    if (p->lb > 1)
+      run_lee_brickell(ctx, rw, rank, tid);
+    if (p->isd)
+      run_isd_stern(ctx, rw, rank, rng_state, tid);
+    if (atomic_fetch_add(&ctx->rw_steps_completed, 1) + 1 == ctx->total_rw_steps)
+      ctx_signal(ctx);
+  }
+}
+
+/**
+ * Brouwer-Zimmermann task `t` for message weight `w`: all sums of `w`
+ * rows of the generator matrix `j=t/k` with the first row `i1=t%k`.
+ * Enumerated depth-first with the partial sums kept for each level
+ * (`sums` has `w` rows of `G` width), so that each message costs a
+ * single row `XOR`, same as in the Gray-code order.
+ */
+static void run_bz_task(distfork_ctx_t *ctx, const int t, const int w,
+                        word *sums, int *idx, rci_t *ee, int tid) {
+  const bz_t * const bz = ctx->bz;
+  const int k = bz->k, n = bz->n;
+  const mzd_t * const G = bz->G[t / k];
+  const wi_t width = G->width;
+  const int i1 = t % k;
+  if (i1 + w > k) return;
+
+  long iter = 0;
+  int lev = 0;
+  idx[0] = i1;
+  while (lev >= 0) {
+    if (idx[lev] > k - (w - lev)) { /** no room for the remaining rows */
+      if (--lev >= 1) idx[lev]++;
+      else break;
+      continue;
+    }
+    if (((++iter & 1023) == 0) && atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed))
+      return;
+    const word * const row = mzd_row_cons(G, idx[lev]);
+    word * const sum = sums + lev * width;
+    if (lev == 0) {
+      for (wi_t j = 0; j < width; j++) sum[j] = row[j];
+    } else {
+      const word * const prev = sum - width;
+      for (wi_t j = 0; j < width; j++) sum[j] = prev[j] ^ row[j];
+    }
+    if (lev == w - 1) {
+      const int limit = rw_limit(ctx, n);
+      int wt = 0;
+      for (wi_t j = 0; (j < width) && (wt < limit); j++)
+        wt += m4ri_bitcount(sum[j]);
+      if (wt < limit) {
+        int cnt = 0;
+        for (rci_t j = nextelement(sum, width, 0); j != -1; j = nextelement(sum, width, j + 1))
+          ee[cnt++] = j;
+        rw_add_cw(ctx, ee, cnt, tid, "BZ");
+      }
+      if (lev == 0) break;
+      idx[lev]++;
+    } else {
+      idx[lev + 1] = idx[lev] + 1;
+      lev++;
+    }
   }
 }
 
@@ -352,8 +1767,20 @@ static void *worker_thread_func(void *arg) {
   worker_arg_t *warg = (worker_arg_t *)arg;
   distfork_ctx_t *ctx = warg->ctx;
   int tid = warg->tid;
-  const int nvar = ctx->p->spaH->cols;
-  const bool enable_rw = (ctx->p->method & 1) != 0;
+  const bool enable_rw = ((ctx->p->method & 1) != 0) && (tid < ctx->num_rw);
+  /** SMT pairs in method 3: while CC needs at most the even threads, odd
+      threads run RW first, next to a CC thread on the same core */
+  const bool rw_first = enable_rw && (ctx->p->method == 3) && (ctx->p->affinity == SYS_AFFINITY_SMT) && (tid & 1);
+  /** in an RW group only the leader has the RW work space */
+  rw_group_t * const grp = (enable_rw && ctx->rw_grp) ? &ctx->rw_grp[tid / ctx->p->rwgroup] : NULL;
+  const bool rw_lead = enable_rw && ((!grp) || (grp->leader == tid));
+
+  /* Pin before anything is allocated, so that the memory is on this thread's NUMA node */
+  if (ctx->ncpu) {
+    const int cpu = ctx->cpu[tid % ctx->ncpu];
+    if (sys_pin_self(cpu) && (ctx->p->debug & 2))
+      fprintf(stderr, "# [thread %d] could not pin to CPU %d\n", tid, cpu);
+  }
 
   /* Initialize min_swei for this thread */
   for (int i = 0; i < MAX_W; i++) {
@@ -361,23 +1788,24 @@ static void *worker_thread_func(void *arg) {
   }
 
   /* Thread-local RW matrices (allocated safely only if RW is enabled) */
-  mzd_t *mH = NULL;
-  mzd_t *mHT_rw = NULL;
-  rci_t *ee = NULL;
-  mzp_t *perm = NULL;
-  mzp_t *pivs = NULL;
-  mzp_t *pivs_srtd = NULL;
-  mzp_t *skip_pivs = NULL;
+  rw_work_t rw = {0};
   uint64_t rng_state = (uint64_t)ctx->p->seed + (uint64_t)tid * 0x9e3779b97f4a7c15ULL + 0x517cc1b727220a95ULL;
 
-  if (enable_rw) {
-    mH = safe_mzd_from_csr(NULL, ctx->p->spaH);
-    mHT_rw = safe_mzd_init(nvar, ctx->p->spaH->rows);
-    ee = malloc((nvar + 2) * sizeof(rci_t));
-    perm = safe_mzp_init(nvar);
-    pivs = safe_mzp_init(nvar);
-    pivs_srtd = safe_mzp_init(nvar);
-    skip_pivs = safe_mzp_init(nvar);
+  if (rw_lead) {
+    rw_work_init(&rw, ctx->p, grp ? &grp->par : NULL);
+  }
+
+  /* Thread-local BZ memory */
+  word *bz_sums = NULL;
+  int *bz_idx = NULL;
+  rci_t *bz_ee = NULL;
+  if (ctx->bz) {
+    const wi_t width = (ctx->bz->n + m4ri_radix - 1) / m4ri_radix;
+    bz_sums = malloc(sizeof(word) * MAX_W * (width + 1));
+    bz_idx = malloc(sizeof(int) * MAX_W);
+    bz_ee = malloc(2 * sizeof(rci_t) * (ctx->bz->n + 1));
+    if (!bz_sums || !bz_idx || !bz_ee)
+      ERROR("memory allocation failed!\n");
   }
 
   /* Thread-local CC memory */
@@ -395,101 +1823,161 @@ static void *worker_thread_func(void *arg) {
         1, sizeof(one_vec_t) + sizeof(int) * (ctx->p->spaH->rows + 1)
     );
   }
+  warg->err = err;
+  warg->urr = urr;
+  warg->syn = syn;
+  warg->fr = calloc(wmax_alloc + 3, sizeof(cc_frame_t));
+  warg->nodes = 0;
+  warg->mark = calloc(ctx->p->spaH->rows + 1, sizeof(uint32_t));
+  warg->taken = calloc(ctx->p->spaH->rows + 1, sizeof(int));
+  warg->stamp = 0;
+  warg->clusters = 0;
+  if ((!warg->fr) || (!warg->mark) || (!warg->taken))
+    ERROR("memory allocation failed!\n");
+  warg->mt = NULL;
+  warg->mitm_hit = warg->mitm_miss = 0;
+  bool hungry = false;
+  cc_task_t task = {0};
 
   while (!atomic_load_explicit(&ctx->stop_flag, memory_order_relaxed)) {
+    const unsigned long seq = ctx_event(ctx);
     if (get_time_sec() - ctx->start_time >= ctx->timeout) {
-      atomic_store(&ctx->stop_flag, true);
+      ctx_stop(ctx);
       break;
     }
 
     bool did_work = false;
 
-    /* 1. Try to take CC work if CC is active (method 2 or 3) */
-    if (ctx->p->method >= 2 && atomic_load(&ctx->cc_round_active)) {
+    /* 1. Try to take CC work if CC is active (method 2 or 3): a start
+       column, then a queued subtree, own or stolen */
+    bool want_cc = false;
+    if (ctx->p->method >= 2 && atomic_load(&ctx->cc_round_active) &&
+        !(rw_first && (atomic_load(&ctx->cc_target_workers) <= (ctx->num_threads + 1) / 2) &&
+          (atomic_load(&ctx->rw_steps_started) < ctx->total_rw_steps))) {
       int active = atomic_load(&ctx->cc_active_workers);
       int target = atomic_load(&ctx->cc_target_workers);
       if (active < target) {
-        int col = atomic_fetch_add(&ctx->cc_col_next, 1);
-        int end = ctx->cc_col_end;
-        if (col <= end) {
-          atomic_fetch_add(&ctx->cc_active_workers, 1);
-          int w = atomic_load(&ctx->cc_weight);
-
-          err->vec[0] = urr->vec[0] = col;
-          err->wei = urr->wei = 1;
-          syn[1]->wei = 0;
-          int swei = one_csr_row_combine(syn[1], syn[0], ctx->mHT_cc, col);
-
-          if (ctx->p->smax && swei > 0 && swei <= ctx->p->smax) {
-            if (swei < warg->min_swei[1]) {
-              warg->min_swei[1] = swei;
-            }
+        want_cc = true;
+        atomic_fetch_add(&ctx->cc_active_workers, 1);
+        /** the current round first, then the look-ahead round `w+1` */
+        int w = atomic_load(&ctx->cc_weight), col = 0;
+        int got = cc_round_take(ctx, w, &col);
+        if (!got && !ctx->bz) {
+          if (cc_task_get(ctx, tid, &task)) {
+            got = 2;
+            w = task.w;
+          } else if (cc_round_take(ctx, w + 1, &col)) {
+            got = 1;
+            w++;
           }
-
-          if (w > 1) {
-            if (swei) {
-              start_CC_recurs_mt(err, urr, syn, w, ctx->max_col_W, ctx->p->spaH, ctx->mHT_cc, warg);
-            }
-          } else {
-            if (!swei) {
-              int nz = (!ctx->p->spaL) || sparse_syndrome_non_zero(ctx->p->spaL, 1, err->vec);
-              if (nz) {
-                pthread_mutex_lock(&ctx->cw_mutex);
-                ctx->p->codewords = codeword_add_maybe(ctx->p, err->vec, 1);
-                atomic_store(&ctx->cc_found_weight, 1);
-                atomic_store(&ctx->dmin, 1);
-                atomic_store(&ctx->dmax, 1);
-                atomic_store(&ctx->stop_flag, true);
-                pthread_mutex_unlock(&ctx->cw_mutex);
-              }
-            }
+        }
+        if (got) {
+          if (hungry) {
+            hungry = false;
+            atomic_fetch_sub(&ctx->cc_hungry, 1);
           }
-          err->wei = urr->wei = 0;
+          cc_round_t * const rd = &ctx->cc_rd[w & 1];
+          const double t0 = get_time_sec();
+          if (ctx->bz)
+            run_bz_task(ctx, col, w, bz_sums, bz_idx, bz_ee, tid);
+          else if (got == 2)
+            cc_run_task(warg, &task);
+          else
+            cc_run_col(warg, col, w);
+          atomic_fetch_add(&rd->busy_us, (long long) (1e6 * (get_time_sec() - t0)));
+          if (rd->cost)
+            atomic_fetch_add_explicit(&rd->cost[got == 2 ? task.col[0] : col], warg->nodes + 1,
+                                      memory_order_relaxed);
+          warg->clusters += warg->nodes;
+          warg->nodes = 0;
+          if (got == 2)
+            atomic_fetch_sub(&rd->pending, 1);
+          else
+            atomic_fetch_sub(&rd->active, 1);
           atomic_fetch_sub(&ctx->cc_active_workers, 1);
+          if (cc_round_done(ctx, w))
+            ctx_signal(ctx);
           did_work = true;
           continue;
         }
+        atomic_fetch_sub(&ctx->cc_active_workers, 1);
+        if (!hungry && !ctx->bz) {
+          hungry = true;
+          atomic_fetch_add(&ctx->cc_hungry, 1);
+        }
       }
     }
+    if (hungry && !want_cc) {
+      hungry = false;
+      atomic_fetch_sub(&ctx->cc_hungry, 1);
+    }
 
-    /* 2. Try to take RW work if RW is active (method 1 or 3) */
-    if (enable_rw && !atomic_load(&ctx->stop_flag)) {
+    /* 2. Try to take RW work if RW is active (method 1 or 3); in a
+       group, help the leader with its steps */
+    if (enable_rw && !rw_lead) {
+      if (atomic_load(&grp->busy)) {
+        rw_group_help(ctx, grp, tid - grp->leader, seq);
+        continue;
+      }
+    }
+    else if (enable_rw && !atomic_load(&ctx->stop_flag)) {
       long cur_s = atomic_load(&ctx->rw_steps_started);
       if (cur_s < ctx->total_rw_steps) {
         long target_s = cur_s + 10;
         if (target_s > ctx->total_rw_steps) target_s = ctx->total_rw_steps;
         if (atomic_compare_exchange_weak(&ctx->rw_steps_started, &cur_s, target_s)) {
           int n_steps = (int)(target_s - cur_s);
-          run_rw_steps(ctx, n_steps, mH, mHT_rw, ee, perm, pivs, pivs_srtd, skip_pivs, &rng_state, tid);
-          did_work = true;
-          continue;
+          if (grp) {
+            atomic_store(&grp->busy, true);
+            ctx_signal(ctx);
+          }
+          run_rw_steps(ctx, n_steps, &rw, &rng_state, tid);
+          if (grp)
+            atomic_store(&grp->busy, false);
         }
+        continue;
       }
     }
 
     if (!did_work) {
-      usleep(100);
+      ctx_wait(ctx, seq);
     }
   }
 
-  if (enable_rw) {
-    safe_mzp_free(skip_pivs);
-    safe_mzp_free(pivs_srtd);
-    safe_mzp_free(perm);
-    safe_mzp_free(pivs);
-    free(ee);
-    safe_mzd_free(mHT_rw);
-    safe_mzd_free(mH);
+  if (rw_lead) {
+    rw_work_free(&rw);
   }
 
+  free(bz_ee);
+  free(bz_idx);
+  free(bz_sums);
+
+  if (hungry) {
+    atomic_fetch_sub(&ctx->cc_hungry, 1);
+  }
   for (int i = 0; i <= wmax_alloc + 2; i++) free(syn[i]);
   free(syn);
   free(err);
   free(urr);
+  free(warg->fr);
+  free(warg->mark);
+  free(warg->taken);
+  cc_mitm_free(warg->mt);
 
   return NULL;
 }
 
+/** @brief wait until all RW steps are done, or the timeout, or stop */
+static void rw_wait_done(distfork_ctx_t *ctx) {
+  for (;;) {
+    const unsigned long seq = ctx_event(ctx);
+    if (atomic_load(&ctx->stop_flag)) break;
+    if (get_time_sec() - ctx->start_time >= ctx->timeout) break;
+    if (atomic_load(&ctx->rw_steps_completed) >= ctx->total_rw_steps) break;
+    ctx_wait(ctx, seq);
+  }
+}
+
 /* Method 1 coordinator */
 static void run_method1_coordinator(distfork_ctx_t *ctx) {
   if (ctx->p->debug & 2) {
@@ -498,28 +1986,21 @@ static void run_method1_coordinator(distfork_ctx_t *ctx) {
   }
 
   while (!atomic_load(&ctx->stop_flag)) {
+    const unsigned long seq = ctx_event(ctx);
     if (get_time_sec() - ctx->start_time >= ctx->timeout) {
-      atomic_store(&ctx->stop_flag, true);
+      ctx_stop(ctx);
       break;
     }
     if (atomic_load(&ctx->rw_steps_completed) >= ctx->total_rw_steps) {
       break;
     }
-    usleep(1000);
+    ctx_wait(ctx, seq);
   }
 }
 
 /* Method 2 coordinator */
 static void run_method2_coordinator(distfork_ctx_t *ctx) {
-  const int nvar = ctx->p->spaH->cols;
   const int wmax = ctx->p->wmax;
-  const int w_start = ctx->p->noscan ? wmax : (ctx->p->dmin > 1 ? ctx->p->dmin : 1);
-
-  if (ctx->p->debug & 2) {
-    fprintf(stderr, "# running method=2 (multithreaded CC) with %d threads, w_start=%d wmax=%d\n",
-            ctx->num_threads, w_start, wmax);
-  }
-
   int w_limit = wmax;
   if (ctx->p->dmax > 0) {
     if (ctx->p->outC && ctx->p->dW > 0) {
@@ -528,13 +2009,20 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
       w_limit = minint(wmax > 0 ? wmax : ctx->p->dmax, ctx->p->dmax);
     }
   }
+  /** `ccpass`: a single round, which finds the lighter codewords as well */
+  const int w_start = ctx->p->ccpass ? w_limit : (ctx->p->noscan ? wmax : (ctx->p->dmin > 1 ? ctx->p->dmin : 1));
+
+  if (ctx->p->debug & 2) {
+    fprintf(stderr, "# running method=2 (multithreaded CC) with %d threads, w_start=%d wmax=%d%s\n",
+            ctx->num_threads, w_start, wmax, ctx->p->ccpass ? ", single pass" : "");
+  }
 
   for (int w = w_start; w <= w_limit; w++) {
     if (atomic_load(&ctx->stop_flag)) break;
     double now = get_time_sec();
     double remaining_time = ctx->timeout - (now - ctx->start_time);
     if (ctx->timeout > 0.0 && remaining_time <= 0.0) {
-      atomic_store(&ctx->stop_flag, true);
+      ctx_stop(ctx);
       break;
     }
 
@@ -554,20 +2042,24 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
           fprintf(stderr, "# CC for w=%d (est %.2fs) exceeds remaining timeout %.2fs, terminating early (dmin=%d)\n",
                   w, t_cc_est / ctx->num_threads, remaining_time, atomic_load(&ctx->dmin));
         }
-        atomic_store(&ctx->stop_flag, true);
+        ctx_stop(ctx);
         break;
       }
     }
 
     int beg = (ctx->p->cbeg >= 0) ? ctx->p->cbeg : 0;
-    int end = (ctx->p->cend >= 0) ? minint(ctx->p->cend, nvar - w) : (nvar - w);
+    int end = cc_round_end(ctx, w);
 
+    /** round `w` may have been started as the look-ahead round */
+    cc_round_t * const rd = &ctx->cc_rd[w & 1];
+    if (!cc_round_is_open(ctx, w))
+      cc_round_open(ctx, w, beg);
     atomic_store(&ctx->cc_weight, w);
-    ctx->cc_col_beg = beg;
-    ctx->cc_col_end = end;
-    atomic_store(&ctx->cc_col_next, beg);
+    if (w + 1 <= w_limit)
+      cc_round_open(ctx, w + 1, beg);
     atomic_store(&ctx->cc_target_workers, ctx->num_threads);
     atomic_store(&ctx->cc_round_active, 1);
+    ctx_signal(ctx);
 
     double cc_start = get_time_sec();
 
@@ -578,25 +2070,39 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
 
     bool round_completed = false;
     while (!atomic_load(&ctx->stop_flag)) {
-      if (get_time_sec() - ctx->start_time >= ctx->timeout) {
-        atomic_store(&ctx->stop_flag, true);
+      const unsigned long seq = ctx_event(ctx);
+      if ((get_time_sec() - ctx->start_time >= ctx->timeout) || atomic_load(&rd->stop)) {
+        ctx_stop(ctx);
         break;
       }
-      if (atomic_load(&ctx->cc_col_next) > end && atomic_load(&ctx->cc_active_workers) == 0) {
+      if (cc_round_done(ctx, w)) {
         round_completed = true;
         break;
       }
-      usleep(100);
+      ctx_wait(ctx, seq);
     }
 
     atomic_store(&ctx->cc_round_active, 0);
+    if (round_completed)
+      cc_round_save_cost(ctx, w);
 
+    /** wall time counted from the promotion; thread time includes the look-ahead */
     double cc_dur = get_time_sec() - cc_start;
     if (w < MAX_W) {
-      ctx->cc_time_per_weight[w] = cc_dur;
+      ctx->cc_time_per_weight[w] = 1e-6 * (double) atomic_load(&rd->busy_us) / ctx->num_threads;
     }
 
+    atomic_min_nz(&ctx->cc_found_weight, atomic_load(&rd->found));
     int cw_found = atomic_load(&ctx->cc_found_weight);
+    if ((cw_found > 0) && ctx->p->ccpass && !round_completed && (cw_found > atomic_load(&ctx->dmin))) {
+      /** an unfinished pass may have missed lighter codewords */
+      if (ctx->p->debug & 1) {
+        fprintf(stderr, "# CC pass up to w=%d stopped after %.3fs (%d CC threads): codeword of weight %d found (dmax=%d, dmin=%d)\n",
+                w, cc_dur, ctx->num_threads, cw_found, atomic_load(&ctx->dmax), atomic_load(&ctx->dmin));
+      }
+      ctx_stop(ctx);
+      break;
+    }
     if (cw_found > 0) {
       atomic_store(&ctx->dmin, cw_found);
       atomic_store(&ctx->dmax, cw_found);
@@ -614,7 +2120,7 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
         }
       } else {
         if (ctx->p->debug & 1) {
-          if (w > cw_found) {
+          if ((w > cw_found) && !ctx->p->ccpass) {
             if (round_completed) {
               fprintf(stderr, "# CC round w=%d finished in %.3fs (%d CC threads): extra dW round completed (dmin=%d, total %lld cws)\n",
                       w, cc_dur, ctx->num_threads, cw_found, ctx->p->num_cws);
@@ -625,7 +2131,7 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
           }
         }
         if (w >= w_limit || !round_completed) {
-          atomic_store(&ctx->stop_flag, true);
+          ctx_stop(ctx);
           break;
         }
       }
@@ -643,6 +2149,71 @@ static void run_method2_coordinator(distfork_ctx_t *ctx) {
   }
 }
 
+/**
+ * BZ coordinator (method 2 or 3 with BZ): round `w` enumerates all
+ * messages of weight `w` in every information set using `n_bz`
+ * threads, then `dmin` is raised to the BZ lower bound.  Stops when
+ * the lower bound reaches `dmax` (or exceeds `dmax+dW` with `outC`).
+ */
+static void run_bz_coordinator(distfork_ctx_t *ctx, const int n_bz) {
+  const bz_t * const bz = ctx->bz;
+  const int extra = (ctx->p->outC && ctx->p->dW > 0) ? ctx->p->dW + 1 : 0;
+
+  if (ctx->p->debug & 2) {
+    fprintf(stderr, "# running BZ with %d threads, %d information sets, k=%d\n",
+            n_bz, bz->num, bz->k);
+  }
+
+  for (int w = 1; (w <= bz->k) && (w < MAX_W); w++) {
+    if (atomic_load(&ctx->stop_flag)) break;
+    int cur_dmax = atomic_load(&ctx->dmax);
+    if (cur_dmax > 0 && atomic_load(&ctx->dmin) >= cur_dmax + extra) {
+      ctx_stop(ctx);
+      break;
+    }
+
+    cc_round_open(ctx, w, 0);
+    atomic_store(&ctx->cc_weight, w);
+    atomic_store(&ctx->cc_target_workers, n_bz);
+    atomic_store(&ctx->cc_round_active, 1);
+    ctx_signal(ctx);
+
+    double bz_start = get_time_sec();
+    bool round_completed = false;
+    while (!atomic_load(&ctx->stop_flag)) {
+      const unsigned long seq = ctx_event(ctx);
+      if (get_time_sec() - ctx->start_time >= ctx->timeout) {
+        ctx_stop(ctx);
+        break;
+      }
+      if (cc_round_done(ctx, w)) {
+        round_completed = true;
+        break;
+      }
+      ctx_wait(ctx, seq);
+    }
+    atomic_store(&ctx->cc_round_active, 0);
+    if (!round_completed) break;
+
+    const int lb = bz_lower_bound(bz, w);
+    if (lb > atomic_load(&ctx->dmin)) {
+      atomic_store(&ctx->dmin, lb);
+    }
+    cur_dmax = atomic_load(&ctx->dmax);
+    if (ctx->p->debug & 1) {
+      fprintf(stderr, "# BZ round w=%d finished in %.3fs (%d BZ threads): lower bound %d, dmax=%d\n",
+              w, get_time_sec() - bz_start, n_bz, lb, cur_dmax);
+    }
+  }
+  int cur_dmax = atomic_load(&ctx->dmax);
+  if (cur_dmax > 0 && atomic_load(&ctx->dmin) >= cur_dmax) {
+    atomic_store(&ctx->dmin, cur_dmax);
+    if (ctx->p->debug & 1) {
+      fprintf(stderr, "# BZ bounds coincide: dmin = dmax = %d\n", cur_dmax);
+    }
+  }
+}
+
 /* Method 3 coordinator */
 static void run_method3_coordinator(distfork_ctx_t *ctx) {
   const int nvar = ctx->p->spaH->cols;
@@ -656,7 +2227,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
   int init_dmax = atomic_load(&ctx->dmax);
   int init_dmin = atomic_load(&ctx->dmin);
   if (init_dmax > 0 && init_dmin >= init_dmax && !ctx->p->outC) {
-    atomic_store(&ctx->stop_flag, true);
+    ctx_stop(ctx);
     return;
   }
 
@@ -675,7 +2246,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
     double now = get_time_sec();
     double remaining_time = ctx->timeout - (now - ctx->start_time);
     if (remaining_time <= 0.0) {
-      atomic_store(&ctx->stop_flag, true);
+      ctx_stop(ctx);
       break;
     }
 
@@ -703,21 +2274,19 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
     if (target_cc_w > max_allowed_w) {
       target_cc_w = max_allowed_w;
     }
+    if (ctx->p->ccpass && w < target_cc_w)
+      w = target_cc_w; /** one round, which finds the lighter codewords as well */
 
     if (cur_dmax > 0 && cur_dmin >= cur_dmax && w > target_cc_w) {
       /* Bracketing converged and all requested dW rounds completed */
       atomic_store(&ctx->dmin, cur_dmax);
-      atomic_store(&ctx->stop_flag, true);
+      ctx_stop(ctx);
       break;
     }
 
     if (w > target_cc_w) {
       /* Let remaining RW steps finish */
-      while (!atomic_load(&ctx->stop_flag)) {
-        if (get_time_sec() - ctx->start_time >= ctx->timeout) break;
-        if (atomic_load(&ctx->rw_steps_completed) >= ctx->total_rw_steps) break;
-        usleep(1000);
-      }
+      rw_wait_done(ctx);
       break;
     }
 
@@ -745,11 +2314,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
         fprintf(stderr, "# CC for w=%d (est %.2fs) exceeds remaining timeout %.2fs, devoting %d threads to RW\n",
                 w, t_cc_est / ctx->num_threads, remaining_time, ctx->num_threads);
       }
-      while (!atomic_load(&ctx->stop_flag)) {
-        if (get_time_sec() - ctx->start_time >= ctx->timeout) break;
-        if (atomic_load(&ctx->rw_steps_completed) >= ctx->total_rw_steps) break;
-        usleep(1000);
-      }
+      rw_wait_done(ctx);
       break;
     }
 
@@ -778,17 +2343,21 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
       if (n_cc >= ctx->num_threads && steps_rem > 0) n_cc = ctx->num_threads - 1;
     }
 
+    /** threads without RW work space run CC */
+    if (n_cc < ctx->num_threads - ctx->num_rw) n_cc = ctx->num_threads - ctx->num_rw;
     int n_rw = ctx->num_threads - n_cc;
 
     int beg = (ctx->p->cbeg >= 0) ? ctx->p->cbeg : 0;
-    int end = (ctx->p->cend >= 0) ? minint(ctx->p->cend, nvar - w) : (nvar - w);
 
+    cc_round_t * const rd = &ctx->cc_rd[w & 1];
+    if (!cc_round_is_open(ctx, w))
+      cc_round_open(ctx, w, beg);
     atomic_store(&ctx->cc_weight, w);
-    ctx->cc_col_beg = beg;
-    ctx->cc_col_end = end;
-    atomic_store(&ctx->cc_col_next, beg);
+    if (w + 1 <= target_cc_w)
+      cc_round_open(ctx, w + 1, beg);
     atomic_store(&ctx->cc_target_workers, n_cc);
     atomic_store(&ctx->cc_round_active, 1);
+    ctx_signal(ctx);
 
     if (ctx->p->debug & 2) {
       fprintf(stderr, "# CC round w=%d started: %d CC threads, %d RW threads (bounds [%d, %d], rem_rw=%ld, rem_time=%.2fs)\n",
@@ -799,25 +2368,37 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
     bool round_completed = false;
 
     while (!atomic_load(&ctx->stop_flag)) {
-      if (get_time_sec() - ctx->start_time >= ctx->timeout) {
-        atomic_store(&ctx->stop_flag, true);
+      const unsigned long seq = ctx_event(ctx);
+      if ((get_time_sec() - ctx->start_time >= ctx->timeout) || atomic_load(&rd->stop)) {
+        ctx_stop(ctx);
         break;
       }
-      if (atomic_load(&ctx->cc_col_next) > end && atomic_load(&ctx->cc_active_workers) == 0) {
+      if (cc_round_done(ctx, w)) {
         round_completed = true;
         break;
       }
-      usleep(100);
+      ctx_wait(ctx, seq);
     }
 
     atomic_store(&ctx->cc_round_active, 0);
+    if (round_completed)
+      cc_round_save_cost(ctx, w);
 
     double cc_dur = get_time_sec() - cc_start;
     if (w < MAX_W) {
-      ctx->cc_time_per_weight[w] = cc_dur * (double)n_cc;
+      ctx->cc_time_per_weight[w] = 1e-6 * (double) atomic_load(&rd->busy_us);
     }
 
+    atomic_min_nz(&ctx->cc_found_weight, atomic_load(&rd->found));
     int cw_found = atomic_load(&ctx->cc_found_weight);
+    if ((cw_found > 0) && ctx->p->ccpass && !round_completed && (cw_found > atomic_load(&ctx->dmin))) {
+      /** an unfinished pass may have missed lighter codewords; RW goes on */
+      if (ctx->p->debug & 1) {
+        fprintf(stderr, "# CC pass up to w=%d stopped after %.3fs (%d CC threads, %d RW threads): codeword of weight %d found (dmax=%d, dmin=%d)\n",
+                w, cc_dur, n_cc, n_rw, cw_found, atomic_load(&ctx->dmax), atomic_load(&ctx->dmin));
+      }
+      break;
+    }
     if (cw_found > 0) {
       atomic_store(&ctx->dmin, cw_found);
       atomic_store(&ctx->dmax, cw_found);
@@ -834,7 +2415,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
         }
       } else {
         if (ctx->p->debug & 1) {
-          if (w > cw_found) {
+          if ((w > cw_found) && !ctx->p->ccpass) {
             if (round_completed) {
               fprintf(stderr, "# CC round w=%d finished in %.3fs (%d CC threads, %d RW threads): extra dW round completed (dmin=%d, total %lld cws)\n",
                       w, cc_dur, n_cc, n_rw, cw_found, ctx->p->num_cws);
@@ -844,7 +2425,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
                     cw_found, n_cc, ctx->p->num_cws);
           }
         }
-        atomic_store(&ctx->stop_flag, true);
+        ctx_stop(ctx);
         break;
       }
     } else if (cur_dmax > 0 && cur_dmin >= cur_dmax) {
@@ -878,7 +2459,7 @@ static void run_method3_coordinator(distfork_ctx_t *ctx) {
                     cur_dmax, cur_dmax + ctx->p->dW, ctx->p->dW);
           }
         } else {
-          atomic_store(&ctx->stop_flag, true);
+          ctx_stop(ctx);
           if (ctx->p->debug & 1) {
             fprintf(stderr, "# bracketing bounds coincide: dmin = dmax = %d\n", cur_dmax);
           }
@@ -900,11 +2481,40 @@ int main(int argc, char **argv) {
     nzlist_read(p->finC, p);
   }
 
-  /* Determine number of threads */
+  /* Determine number of threads: the CPUs of the affinity mask and of the cgroup quota */
   int num_threads = p->threads;
   if (num_threads <= 0) {
-    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
-    num_threads = (nprocs > 0) ? (int)nprocs : 4;
+    num_threads = sys_cpu_count();
+  }
+
+  /* Memory budget: a share for RW work space, one for the codeword store, one for the CC tables and `ccmitm` */
+  const long long mem = (p->mem > 0) ? ((long long) p->mem << 20) : sys_mem_limit();
+  int num_rw = num_threads;
+  if ((p->method & 1) && (mem > 0)) {
+    /** one RW work space per group of `rwgroup` threads */
+    const long long rw_bytes = rw_work_bytes(p), max_grp = (long long) (MEM_RW_SHARE * mem / rw_bytes);
+    if ((num_rw + p->rwgroup - 1) / p->rwgroup > max_grp)
+      num_rw = (int) (max_grp * p->rwgroup);
+    if (num_rw < 1) {
+      num_rw = minint(p->rwgroup, num_threads);
+      fprintf(stderr, "# WARNING: RW needs %.1f MiB per thread, over the memory budget of %.1f MiB\n",
+              rw_bytes / 1048576.0, mem / 1048576.0);
+    }
+    /** RW only: the other threads would have nothing to do */
+    if (p->method == 1)
+      num_threads = num_rw;
+  }
+  const long long cc_share = (mem > 0) ? (long long) (MEM_CC_SHARE * mem) : (1LL << 30);
+  if (mem > 0) {
+    const int w_cw = minint(p->dmax > 0 ? p->dmax : (p->wmax > 0 ? p->wmax : MAX_W), p->n0) + (p->dW > 0 ? p->dW : 0);
+    const long long max_cw = (long long) (MEM_CW_SHARE * mem / CW_BYTES(w_cw));
+    p->cw_cap = max_cw > 0 ? max_cw : 1;
+  }
+  if (p->debug & 2) {
+    fprintf(stderr, "# %d threads, memory budget %.1f MiB", num_threads, mem / 1048576.0);
+    if (p->method & 1)
+      fprintf(stderr, ", RW in %d threads", num_rw);
+    fprintf(stderr, ", codeword store up to %lld\n", p->cw_cap);
   }
 
   double timeout = (p->timeout > 0.0) ? p->timeout : 60.0;
@@ -913,6 +2523,21 @@ int main(int argc, char **argv) {
   memset(&ctx, 0, sizeof(ctx));
   ctx.p = p;
   ctx.num_threads = num_threads;
+  ctx.num_rw = num_rw;
+  if (p->affinity != SYS_AFFINITY_NONE) {
+    ctx.cpu = malloc(sizeof(int) * num_threads);
+    if (!ctx.cpu)
+      ERROR("memory allocation failed!\n");
+    ctx.ncpu = sys_cpu_order(ctx.cpu, num_threads, p->affinity);
+    if (ctx.ncpu == 0) {
+      fprintf(stderr, "# WARNING: affinity=%d is not supported on this system, ignored\n", p->affinity);
+    } else if (p->debug & 2) {
+      fprintf(stderr, "# affinity=%d, threads pinned to CPUs (NUMA node):", p->affinity);
+      for (int i = 0; i < num_threads; i++)
+        fprintf(stderr, " %d(%d)", ctx.cpu[i % ctx.ncpu], sys_cpu_node(ctx.cpu[i % ctx.ncpu]));
+      fprintf(stderr, "\n");
+    }
+  }
   ctx.timeout = timeout;
   ctx.start_time = get_time_sec();
   ctx.dexp = p->dexp;
@@ -952,18 +2577,97 @@ int main(int argc, char **argv) {
 
   atomic_init(&ctx.cc_found_weight, 0);
   atomic_init(&ctx.stop_flag, false);
+  atomic_init(&ctx.ev_seq, 0);
+  atomic_init(&ctx.ev_waiters, 0);
+  pthread_mutex_init(&ctx.ev_lock, NULL);
+  pthread_condattr_t ev_attr;
+  pthread_condattr_init(&ev_attr);
+  pthread_condattr_setclock(&ev_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&ctx.ev_cond, &ev_attr);
+  pthread_condattr_destroy(&ev_attr);
   atomic_init(&ctx.rw_steps_started, 0);
   atomic_init(&ctx.rw_steps_completed, 0);
   atomic_init(&ctx.cc_weight, 1);
-  atomic_init(&ctx.cc_col_next, 0);
+  for (int i = 0; i < 2; i++) {
+    atomic_init(&ctx.cc_rd[i].next, 0);
+    atomic_init(&ctx.cc_rd[i].active, 0);
+    atomic_init(&ctx.cc_rd[i].pending, 0);
+    atomic_init(&ctx.cc_rd[i].found, 0);
+    atomic_init(&ctx.cc_rd[i].stop, false);
+    atomic_init(&ctx.cc_rd[i].busy_us, 0);
+  }
   atomic_init(&ctx.cc_active_workers, 0);
   atomic_init(&ctx.cc_target_workers, 0);
   atomic_init(&ctx.cc_round_active, 0);
+  atomic_init(&ctx.cc_hungry, 0);
+  ctx.cc_dq = calloc(num_threads, sizeof(cc_deque_t));
+  if (!ctx.cc_dq)
+    ERROR("memory allocation failed!\n");
+  for (int i = 0; i < num_threads; i++) {
+    pthread_mutex_init(&ctx.cc_dq[i].lock, NULL);
+    atomic_init(&ctx.cc_dq[i].num, 0);
+  }
 
-  pthread_mutex_init(&ctx.cw_mutex, NULL);
+  if ((p->debug & 2) && (p->method & 1) && (p->steps > 0))
+    fprintf(stderr, "# RW elimination: %s row XOR kernel\n", bmat_kernel_name());
 
-  ctx.mHT_cc = csr_transpose(NULL, p->spaH);
-  ctx.max_col_W = csr_max_row_wght(ctx.mHT_cc);
+  /* BZ instead of CC: forced, or automatic for a dense `H` in method 3 */
+  const double density = (double) p->spaH->p[p->spaH->rows] / ((double) p->spaH->rows * p->spaH->cols);
+  if ((p->method >= 2) && ((p->bz == 1) || ((p->bz < 0) && (p->method == 3) && (density >= BZ_AUTO_DENSITY)))) {
+    if ((p->debug & 2) && (p->bz < 0)) {
+      fprintf(stderr, "# H density %g >= %g, using BZ instead of CC\n", density, BZ_AUTO_DENSITY);
+    }
+    ctx.bz = bz_init(p->spaH, p->debug);
+  }
+  if ((p->method >= 2) && !ctx.bz) {
+    const int nvar = p->spaH->cols;
+    ctx.mHT_cc = csr_transpose(NULL, p->spaH);
+    ctx.max_col_W = csr_max_row_wght(ctx.mHT_cc);
+    cc_coltab_init(&ctx.cc_col, ctx.mHT_cc);
+    ctx.mH_cc = p->ccbranch ? csr_transpose(NULL, ctx.mHT_cc) : NULL;
+    /** the row neighbour lists only speed up `cc_bound()`: at most `CC_NBR_MAX` entries, within the CC share */
+    const long long nbr_max = (cc_share - cc_tables_bytes(&ctx)) / (long long) sizeof(int) - (p->spaH->rows + 1);
+    ctx.cc_nbr = cc_row_nbrs(p->spaH, ctx.mHT_cc, (nbr_max < CC_NBR_MAX) ? nbr_max : CC_NBR_MAX);
+    if ((!ctx.cc_nbr) && (p->debug & 2))
+      fprintf(stderr, "# CC row neighbour lists over the memory budget, not used\n");
+    /** the `ccmitm` tables get what the CC tables leave of the CC share, or `ccmem` */
+    const long long cc_tables = cc_tables_bytes(&ctx);
+    if (p->ccmitm) {
+      const long long mitm_bytes = ((p->ccmem > 0) ? ((long long) p->ccmem << 20) : (cc_share - cc_tables)) / num_threads;
+      ctx.cc_mitm_bytes = (mitm_bytes < (1 << 20)) ? (1 << 20) : mitm_bytes;
+    }
+    if (p->debug & 2)
+      fprintf(stderr, "# CC tables %.1f MiB of the CC memory share %.1f MiB\n",
+              cc_tables / 1048576.0, cc_share / 1048576.0);
+    ctx.cc_cost = calloc(nvar, sizeof(long long));
+    if (!ctx.cc_cost)
+      ERROR("memory allocation failed!\n");
+    for (int i = 0; i < 2; i++) {
+      ctx.cc_rd[i].order = malloc(sizeof(int) * nvar);
+      ctx.cc_rd[i].cost = calloc(nvar, sizeof(atomic_llong));
+      if ((!ctx.cc_rd[i].order) || (!ctx.cc_rd[i].cost))
+        ERROR("memory allocation failed!\n");
+    }
+  }
+
+  if ((p->method & 1) && (p->rwgroup > 1)) {
+    const int ngrp = (num_rw + p->rwgroup - 1) / p->rwgroup;
+    ctx.rw_grp = calloc(ngrp, sizeof(rw_group_t));
+    if (!ctx.rw_grp)
+      ERROR("memory allocation failed!\n");
+    for (int i = 0; i < ngrp; i++) {
+      rw_group_t * const g = &ctx.rw_grp[i];
+      g->par.run = rw_group_run;
+      g->leader = i * p->rwgroup;
+      g->par.nthreads = minint(p->rwgroup, num_rw - g->leader);
+      atomic_init(&g->busy, false);
+      atomic_init(&g->next, 0);
+      atomic_init(&g->nchunk, 0);
+      atomic_init(&g->done, 0);
+    }
+    if (p->debug & 2)
+      fprintf(stderr, "# RW in %d group(s) of up to %d threads sharing one elimination\n", ngrp, p->rwgroup);
+  }
 
   /* Allocate and launch worker threads */
   ctx.threads = malloc(num_threads * sizeof(pthread_t));
@@ -980,6 +2684,13 @@ int main(int argc, char **argv) {
 
   if (p->method == 1) {
     run_method1_coordinator(&ctx);
+  } else if (ctx.bz) {
+    /* with method 3, about a quarter of the threads keep running RW */
+    int n_rw = (p->method == 3 && num_threads > 1) ? minint((num_threads + 3) / 4, num_rw) : 0;
+    run_bz_coordinator(&ctx, num_threads - n_rw);
+    if (p->method == 3) {
+      rw_wait_done(&ctx);
+    }
   } else if (p->method == 2) {
     run_method2_coordinator(&ctx);
   } else if (p->method == 3) {
@@ -989,11 +2700,20 @@ int main(int argc, char **argv) {
   }
 
   /* Signal stop and wait for all workers */
-  atomic_store(&ctx.stop_flag, true);
+  ctx_stop(&ctx);
   for (int i = 0; i < num_threads; i++) {
     pthread_join(ctx.threads[i], NULL);
   }
 
+  if (atomic_load(&p->cw_keep_w) != INT_MAX) {
+    fprintf(stderr, "# WARNING: codeword store full at %lld codewords (memory budget), those heavier than %d not kept\n",
+            p->cw_cap, atomic_load(&p->cw_keep_w));
+  }
+  else if (p->cw_cap && (atomic_load(&p->num_cws) >= p->cw_cap)) {
+    fprintf(stderr, "# WARNING: codeword store full at %lld codewords (memory budget), others not kept\n",
+            p->cw_cap);
+  }
+
   int final_dmin = atomic_load(&ctx.dmin);
   int final_dmax = atomic_load(&ctx.dmax);
   int cc_found = atomic_load(&ctx.cc_found_weight);
@@ -1009,8 +2729,26 @@ int main(int argc, char **argv) {
     fprintf(stderr, "# early termination due to wmin=%d (cw of weight %d <= wmin found)\n", p->wmin, final_dmax);
   }
 
+  if ((p->method & 2) && !ctx.bz && (p->debug & 2)) {
+    long long clusters = 0;
+    for (int i = 0; i < num_threads; i++)
+      clusters += args[i].clusters;
+    fprintf(stderr, "# CC: %lld clusters checked, branching on the %s unsatisfied row\n",
+            clusters, p->ccbranch ? "shortest" : "first");
+  }
+
+  if (p->ccmitm && (p->method & 2) && !ctx.bz && (p->debug & 2)) {
+    long long hit = 0, miss = 0;
+    for (int i = 0; i < num_threads; i++) {
+      hit += args[i].mitm_hit;
+      miss += args[i].mitm_miss;
+    }
+    fprintf(stderr, "# ccmitm: %lld second-half searches, %lld reused from the table (%.1f MiB per thread)\n",
+            miss, hit, ctx.cc_mitm_bytes / 1048576.0);
+  }
+
   /* Confinement profile output (if smax > 0 and CC was run) */
-  if (p->smax && p->method >= 2) {
+  if (p->smax && p->method >= 2 && !ctx.bz) {
     int max_w_analyzed = (final_dmin > 1) ? (final_dmin - 1) : ((p->wmax > 0) ? p->wmax : 0);
     if (cc_found > 0) max_w_analyzed = cc_found;
     if (max_w_analyzed > 0) {
@@ -1067,19 +2805,39 @@ int main(int argc, char **argv) {
   }
 
   if (p->debug & 32) {
-    cw_vec_t *cw;
-    for (cw = p->codewords; cw != NULL; cw = (cw_vec_t *)(cw->hh.next)) {
+    long long int num;
+    cw_vec_t **list = codeword_list(p, &num);
+    for (long long int j = 0; j < num; j++) {
+      const cw_vec_t * const cw = list[j];
       fprintf(stderr, "# cw: [ ");
       for (int i = 0; i < cw->weight; i++) fprintf(stderr, "%d ", 1 + cw->arr[i]);
       fprintf(stderr, "] cnt=%d\n", cw->cnt);
     }
+    free(list);
   }
 
   /* Cleanup */
+  cc_coltab_free(&ctx.cc_col);
+  csr_free(ctx.mH_cc);
+  csr_free(ctx.cc_nbr);
   csr_free(ctx.mHT_cc);
+  ctx.bz = bz_free(ctx.bz);
+  for (int i = 0; i < num_threads; i++) {
+    pthread_mutex_destroy(&ctx.cc_dq[i].lock);
+    free(ctx.cc_dq[i].task);
+  }
+  free(ctx.cc_dq);
+  for (int i = 0; i < 2; i++) {
+    free(ctx.cc_rd[i].order);
+    free(ctx.cc_rd[i].cost);
+  }
+  free(ctx.cc_cost);
+  pthread_cond_destroy(&ctx.ev_cond);
+  pthread_mutex_destroy(&ctx.ev_lock);
   free(ctx.threads);
+  free(ctx.cpu);
+  free(ctx.rw_grp);
   free(args);
-  pthread_mutex_destroy(&ctx.cw_mutex);
 
   var_kill(p);
 
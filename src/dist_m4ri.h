@@ -19,5 +19,39 @@
     return va-vb;
   }
 
+  /** @brief sort `a[0...n-1]` (non-negative, below `2^24`) in increasing order
+   *  insertion sort for short arrays, else LSD radix sort with 8-bit digits;
+   *  `tmp` is scratch space of size at least `n`
+   */
+  static inline void sort_rci_t(int * const a, const int n, int * const tmp){
+    if (n <= 32){
+      for(int i = 1; i < n; i++){
+	const int v = a[i];
+	int j = i;
+	for(; (j > 0) && (a[j-1] > v); j--)
+	  a[j] = a[j-1];
+	a[j] = v;
+      }
+      return;
+    }
+    int max = 0;
+    for(int i = 0; i < n; i++)
+      max |= a[i];
+    int *src = a, *dst = tmp;
+    for(int shift = 0; (max >> shift) != 0; shift += 8){
+      int cnt[257] = {0};
+      for(int i = 0; i < n; i++)
+	cnt[((src[i] >> shift) & 255) + 1]++;
+      for(int d = 0; d < 256; d++)
+	cnt[d + 1] += cnt[d];
+      for(int i = 0; i < n; i++)
+	dst[cnt[(src[i] >> shift) & 255]++] = src[i];
+      int * const t = src; src = dst; dst = t;
+    }
+    if (src != a)
+      for(int i = 0; i < n; i++)
+	a[i] = src[i];
+  }
+
 
 #endif /* DIST_M4RI */
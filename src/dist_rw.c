@@ -75,6 +75,7 @@ int do_RW_dist(params_t * const p){
   mzp_t * pivs=mzp_init(nvar); /** list of pivot columns */
   mzp_t * pivs_srtd=mzp_init(nvar); /** list of pivot columns */
   mzp_t * skip_pivs=mzp_init(nvar); /** list of pivot columns */
+  word * tab = mzd_echelon_m4ri_tab(mH); /** M4RI table */
   if((!pivs) || (!perm))
     ERROR("memory allocation failed!\n");
 
@@ -83,27 +84,23 @@ int do_RW_dist(params_t * const p){
     mzp_set_ui(perm,1);
     perm=perm_p_trans(perm,pivs,0); /**< corresponding permutation */
 
-    /** full row echelon form of `H` (gauss) using the order in `perm` */
-    int rank=0;
-    for(int i=0; i< nvar; i++){
-      int col=perm->values[i];
-      int ret=gauss_one(mH, col, rank);
-      if(ret)
-        pivs->values[rank++]=col;
-    }
+    /** `pivs_srtd` holds the inverse permutation here */
+    for(int i=0; i< nvar; i++)
+      pivs_srtd->values[perm->values[i]] = i;
+
+    /** full row echelon form of `H` using the order in `perm`;
+	pivots are in permuted positions */
+    mH = mzd_from_csr_perm(mH, spaH0, pivs_srtd);
+    int rank = mzd_echelon_m4ri(mH, pivs, tab);
 
-    /** construct skip-pivot permutation */
-    pivs_srtd = mzp_copy(pivs_srtd,pivs);
-    qsort(pivs_srtd->values, rank, sizeof(pivs->values[0]), cmp_rci_t);
-    int end=-1, num=0;
-    for(int i=0; i < rank; i++){
-      int beg = end + 1;
-      end = pivs_srtd->values[i];
-      for(int j = beg; j < end; j++)
-	skip_pivs->values[num++] = j;
+    /** construct skip-pivot list, pivots are increasing */
+    int num=0;
+    for(int i=0, q=0; q < nvar; q++){
+      if((i < rank) && (pivs->values[i] == q))
+	i++;
+      else
+	skip_pivs->values[num++] = q;
     }
-    for(int j = end + 1 ; j < nvar; j++)
-      skip_pivs->values[num++] = j;
     
 #ifndef NDEBUG
     if (num + rank != nvar)
@@ -127,7 +124,8 @@ int do_RW_dist(params_t * const p){
     int k = nvar - rank;
     for (int ir=0; ir< k; ir++){ /** each row in the dual matrix */
       int cnt=0; /** how many non-zero elements */
-      const int col = ee[cnt++] = skip_pivs->values[ir];
+      const int col = skip_pivs->values[ir];
+      ee[cnt++] = perm->values[col];
       int limit = nvar + 1;
       int cur_d = (minW <= nvar) ? minW : 0;
       if (cur_d > 0) {
@@ -140,7 +138,7 @@ int do_RW_dist(params_t * const p){
 #if (NEW==0) /** older version going over columns of `H` */
       for(int ix=0; ix<rank; ix++){
         if(mzd_read_bit(mH,ix,col))
-          ee[cnt++] = pivs->values[ix];
+          ee[cnt++] = perm->values[pivs->values[ix]];
 	if (cnt >= limit) /** `cw` of no interest */
 	  break;
       }
@@ -154,7 +152,7 @@ int do_RW_dist(params_t * const p){
       while (ix < rank){
 	int res = mzd_find_pivot(mH, ix, col, &ix, &ic);
 	if((res)&&(ic==col)){
-	  ee[cnt++] = pivs->values[ix++];
+	  ee[cnt++] = perm->values[pivs->values[ix++]];
 	  //	  printf("cnt=%d j=%d\n",cnt,ix); 
 	  if (cnt >= limit) /** `cw` of no interest */
 	    break;
@@ -169,7 +167,7 @@ int do_RW_dist(params_t * const p){
 	j=nextelement(rawrow,mHT->width,j);
 	if(j==-1) // empty line after simplification
 	  break; 
-	ee[cnt++] = pivs->values[j++];
+	ee[cnt++] = perm->values[pivs->values[j++]];
       }
 #endif /* NEW */              
       if (cnt < limit){
@@ -194,7 +192,7 @@ int do_RW_dist(params_t * const p){
 	if(nz){ /** we got non-trivial codeword! */
 	  /** TODO: try local search to `lerr` (if 2 or larger) */
 	  /** at this point we have `cnt` codeword indices in `ee` */
-          p->codewords = codeword_add_maybe(p, ee, cnt);
+          codeword_add_maybe(p, ee, cnt);
 	  if(debug&16){
 	    printf("# step=%d row=%d minW=%d found cw of W=%d: [",ii,ir,minW,cnt);
 	    const int max = ((cnt<25) || (debug&2048)) ?  cnt : 25 ;
@@ -231,6 +229,7 @@ int do_RW_dist(params_t * const p){
   mzp_free(perm);
   mzp_free(pivs);
   free(ee);
+  free(tab);
   if(mHT)
     mzd_free(mHT);
   mzd_free(mH);
@@ -362,12 +361,15 @@ int main(int argc, char **argv){
       nzlist_write(p->outC, comment, p);
     }
     if (p->debug & 32) {
-      cw_vec_t *cw;
-      for(cw = p->codewords; cw != NULL; cw = (cw_vec_t *)(cw->hh.next)){
+      long long int num;
+      cw_vec_t **list = codeword_list(p, &num);
+      for(long long int j=0; j<num; j++){
+        const cw_vec_t * const cw = list[j];
         printf("# cw: [ ");
         for(int i=0; i<cw->weight; i++) printf("%d ", 1 + cw->arr[i]);
         printf("] cnt=%d\n", cw->cnt);
       }
+      free(list);
     }
     var_kill(p);
     
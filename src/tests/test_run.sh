@@ -266,6 +266,85 @@ assert_output "$BIN_FORK method=3 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLE
 # Test 40: conflicting debug parameters error
 assert_output "$BIN debug=1 debug=2 method=2 fdem=$EXAMPLES_DIR/surf_d3.dem wmax=2" 255 "" "debug parameter specified multiple times with conflicting values"
 
+# Test 41: incremental information sets in RW
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=1000 rwinc=2 debug=0 threads=4" 0 "^1 5 [0-9]+$" ""
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=10 rwinc=-1 debug=0" 255 "" "rwinc=-1 should be non-negative"
+
+# Test 42: Stern collision search in RW
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=20 isd=stern debug=0 threads=4" 0 "^1 5 [0-9]+$" ""
+
+# Test 43: unsupported isd variant error
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx isd=dumer debug=0" 255 "" "unsupported isd=dumer"
+
+# Test 44: Lee-Brickell pairs of dual rows in RW
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=10 lb=2 debug=0 threads=4" 0 "^1 5 [0-9]+$" ""
+
+# Test 45: Brouwer-Zimmermann instead of CC, extended Golay code
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/golay24H.mmx bz=1 debug=0 threads=4" 0 "^8 8 0$" ""
+
+# Test 46: BZ chosen automatically for a dense H in method 3
+assert_output "$BIN_FORK method=3 finH=$EXAMPLES_DIR/golay24H.mmx debug=2 threads=4" 0 "^8 8 [0-9]+$" "using BZ instead of CC"
+
+# Test 47: sparse elimination in RW
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/QX900.mtx steps=100 rwsparse=1 debug=0 threads=4" 0 "^1 5 [0-9]+$" ""
+
+# Test 48: sparse elimination falls back to dense on large fill
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=100 rwsparse=1 debug=2 threads=4" 0 "^1 5 [0-9]+$" "switching to dense elimination"
+
+# Test 49: threads pinned to SMT pairs in method 3
+assert_output "$BIN_FORK method=3 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=100 affinity=2 debug=2 threads=4" 0 "^5 5 [0-9]+$" "threads pinned to CPUs"
+
+# Test 50: invalid affinity mode
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx affinity=3 debug=0" 255 "" "affinity=3 should be"
+
+# Test 51: memory budget limits the number of RW threads
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=200 mem=5 debug=2 threads=4" 0 "^1 5 [0-9]+$" "RW in 2 threads"
+
+# Test 52: threads without RW work space run CC in method 3
+assert_output "$BIN_FORK method=3 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=100 mem=3 debug=2 threads=3" 0 "^5 5 [0-9]+$" "RW in 1 threads"
+
+# Test 53: RW groups sharing one elimination
+assert_output "$BIN_FORK method=3 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=200 rwgroup=2 debug=2 threads=4" 0 "^5 5 [0-9]+$" "2 threads sharing one elimination"
+
+# Test 54: RW groups need dense elimination
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx rwgroup=2 rwsparse=1 debug=0" 255 "" "needs dense elimination"
+
+# Test 55: CC meeting in the middle with a table of second halves
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx wmax=5 ccmitm=1 ccmem=16 debug=2 threads=2" 0 "^5 5 [0-9]+$" "reused from the table"
+
+# Test 56: invalid ccmitm
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx wmax=5 ccmitm=2 debug=0" 255 "" "ccmitm=2 should be"
+
+# Test 57: last CC level by syndrome lookup (smax=0), weight 6 with a full column range
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx wmax=6 noscan=1 smax=0 debug=0" 0 "^6 6 [0-9]+$" ""
+
+# Test 58: CC pruning keeps the confinement profile (smax)
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/c204H.mmx wmax=6 smax=5 debug=1 threads=2" 0 "^7 0 0$" "w=4 min non-zero syndrome weight 2"
+
+# Test 59: single CC pass, lower bound without codewords
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/c1920H.mmx wmax=10 ccpass=1 debug=1 threads=2" 0 "^11 0 0$" "CC w=10 completed.*dmin=11"
+
+# Test 60: single CC pass finds the lighter codewords, also with ccmitm
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx wmax=7 ccpass=1 ccmitm=1 debug=0 threads=2" 0 "^5 5 0$" ""
+
+# Test 61: ccpass with noscan
+assert_output "$BIN_FORK method=2 finH=$EXAMPLES_DIR/c1920H.mmx wmax=10 ccpass=1 noscan=1 debug=0" 255 "" "ccpass=1 can not be used with noscan=1"
+
+# Test 62: CC branching on the unsatisfied row with the fewest columns left
+assert_output "$BIN_FORK method=2 fdem=$EXAMPLES_DIR/surf_d3.dem wmax=7 smax=0 ccbranch=1 debug=2 threads=2" 0 "^3 3 0$" "branching on the shortest unsatisfied row"
+
+# Test 63: invalid ccbranch
+assert_output "$BIN_FORK method=2 fdem=$EXAMPLES_DIR/surf_d3.dem wmax=7 ccbranch=2 debug=0" 255 "" "ccbranch=2 should be"
+
+# Test 64: full codeword store (small mem) keeps the lightest codewords
+TEMP_MEM_CWS=$(mktemp --suffix=.nz)
+assert_output "$BIN_FORK method=1 finH=$EXAMPLES_DIR/surf_d5_H.mmx finL=$EXAMPLES_DIR/surf_d5_L.mmx steps=300 dW=10 mem=1 seed=1 outC=$TEMP_MEM_CWS debug=0 threads=2" 0 "^1 5 [0-9]+$" "codeword store full"
+if [ "$(grep -v '^%' "$TEMP_MEM_CWS" | awk '{print $1}' | sort -n | head -1)" != "5" ]; then
+    echo "  [FAIL] Lightest codeword in the file is not of weight 5"
+    FAILED=1
+fi
+rm -f "$TEMP_MEM_CWS"
+
 if [ $FAILED -ne 0 ]; then
     echo "Some tests failed!"
     exit 1
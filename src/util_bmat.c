@@ -0,0 +1,405 @@
+/************************************************************************
+ * @file util_bmat.c
+ * @brief packed binary matrices with a row index table for the RW
+ * elimination kernel; row XOR with AVX2 / AVX-512 chosen at run time
+ *
+ * The SIMD kernels are compiled with `target` attributes, so the
+ * binary does not depend on `-march`; the fastest version supported
+ * by the CPU is selected once at program start.
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+#include "util_bmat.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BMAT_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static inline int minint_bmat(const int a, const int b){
+  return a < b ? a : b;
+}
+
+static void xor_scalar(word * const dst, const word * const src, const size_t n){
+  for(size_t i = 0; i < n; i++)
+    dst[i] ^= src[i];
+}
+
+static void xor3_scalar(word * const dst, const word * const a, const word * const b, const size_t n){
+  for(size_t i = 0; i < n; i++)
+    dst[i] = a[i] ^ b[i];
+}
+
+#ifdef BMAT_X86
+__attribute__((target("avx2")))
+static void xor_avx2(word * const dst, const word * const src, const size_t n){
+  size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    const __m256i x = _mm256_loadu_si256((const __m256i *) (dst + i));
+    const __m256i y = _mm256_loadu_si256((const __m256i *) (src + i));
+    _mm256_storeu_si256((__m256i *) (dst + i), _mm256_xor_si256(x, y));
+  }
+  for(; i < n; i++)
+    dst[i] ^= src[i];
+}
+
+__attribute__((target("avx2")))
+static void xor3_avx2(word * const dst, const word * const a, const word * const b, const size_t n){
+  size_t i = 0;
+  for(; i + 4 <= n; i += 4){
+    const __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+    const __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+    _mm256_storeu_si256((__m256i *) (dst + i), _mm256_xor_si256(x, y));
+  }
+  for(; i < n; i++)
+    dst[i] = a[i] ^ b[i];
+}
+
+__attribute__((target("avx512f")))
+static void xor_avx512(word * const dst, const word * const src, const size_t n){
+  size_t i = 0;
+  for(; i + 8 <= n; i += 8){
+    const __m512i x = _mm512_loadu_si512((const void *) (dst + i));
+    const __m512i y = _mm512_loadu_si512((const void *) (src + i));
+    _mm512_storeu_si512((void *) (dst + i), _mm512_xor_si512(x, y));
+  }
+  for(; i < n; i++)
+    dst[i] ^= src[i];
+}
+
+__attribute__((target("avx512f")))
+static void xor3_avx512(word * const dst, const word * const a, const word * const b, const size_t n){
+  size_t i = 0;
+  for(; i + 8 <= n; i += 8){
+    const __m512i x = _mm512_loadu_si512((const void *) (a + i));
+    const __m512i y = _mm512_loadu_si512((const void *) (b + i));
+    _mm512_storeu_si512((void *) (dst + i), _mm512_xor_si512(x, y));
+  }
+  for(; i < n; i++)
+    dst[i] = a[i] ^ b[i];
+}
+#endif /* BMAT_X86 */
+
+void (*bmat_xor)(word * const dst, const word * const src, const size_t n) = xor_scalar;
+void (*bmat_xor3)(word * const dst, const word * const a, const word * const b, const size_t n) = xor3_scalar;
+static const char *bmat_kernel = "scalar";
+
+/** select the kernels once, before `main()` and any threads */
+__attribute__((constructor))
+static void bmat_dispatch_init(void){
+#ifdef BMAT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")){
+    bmat_xor = xor_avx512;
+    bmat_xor3 = xor3_avx512;
+    bmat_kernel = "avx512";
+  }
+  else if (__builtin_cpu_supports("avx2")){
+    bmat_xor = xor_avx2;
+    bmat_xor3 = xor3_avx2;
+    bmat_kernel = "avx2";
+  }
+#endif
+}
+
+const char * bmat_kernel_name(void){
+  return bmat_kernel;
+}
+
+bmat_arena_t * bmat_arena_init(void){
+  bmat_arena_t *A = calloc(1, sizeof(bmat_arena_t));
+  if (!A)
+    ERROR("memory allocation failed!\n");
+  return A;
+}
+
+bmat_arena_t * bmat_arena_free(bmat_arena_t *A){
+  if (A){
+    for(int i = 0; i < A->nblk; i++)
+      free(A->blk[i]);
+    free(A->blk);
+    free(A);
+  }
+  return NULL;
+}
+
+void * bmat_arena_alloc(bmat_arena_t *A, const size_t size){
+  const size_t len = (size + 63) / 64 * 64;
+  if ((A->nblk == 0) || (A->used + len > A->size)){
+    /** a new block; the rest of the last one is not used */
+    size_t bsize = len > BMAT_ARENA_BLK ? len : BMAT_ARENA_BLK;
+    const size_t align = bsize >= BMAT_HUGE ? BMAT_HUGE : 64;
+    bsize = (bsize + align - 1) / align * align;
+    char *b = aligned_alloc(align, bsize);
+    A->blk = realloc(A->blk, sizeof(char *) * (A->nblk + 1));
+    if ((!b) || (!A->blk))
+      ERROR("memory allocation failed!\n");
+#ifdef MADV_HUGEPAGE
+    if (align == BMAT_HUGE)
+      madvise(b, bsize, MADV_HUGEPAGE); /** advisory only, failure is fine */
+#endif
+    A->blk[A->nblk++] = b;
+    A->size = bsize;
+    A->used = 0;
+  }
+  void * const ptr = A->blk[A->nblk - 1] + A->used;
+  A->used += len;
+  return ptr;
+}
+
+mzp_t * bmat_arena_perm(bmat_arena_t *A, const rci_t length){
+  mzp_t *P = bmat_arena_alloc(A, sizeof(mzp_t));
+  P->values = bmat_arena_alloc(A, sizeof(rci_t) * (length > 0 ? length : 1));
+  P->length = length;
+  for(rci_t i = 0; i < length; i++)
+    P->values[i] = i;
+  return P;
+}
+
+bmat_t * bmat_init_arena(bmat_arena_t *A, const int nrows, const int ncols){
+  bmat_t *M = A ? bmat_arena_alloc(A, sizeof(bmat_t)) : malloc(sizeof(bmat_t));
+  if (!M)
+    ERROR("memory allocation failed!\n");
+  M->arena = A;
+  M->nrows = nrows;
+  M->ncols = ncols;
+  M->width = ((ncols + m4ri_radix - 1) / m4ri_radix + BMAT_PAD - 1) / BMAT_PAD * BMAT_PAD;
+  if (M->width == 0)
+    M->width = BMAT_PAD;
+  const size_t size = sizeof(word) * (size_t) M->width * (nrows > 0 ? nrows : 1);
+  const size_t rsize = sizeof(word *) * (nrows > 0 ? nrows : 1);
+  M->data = A ? bmat_arena_alloc(A, size) : aligned_alloc(64, size);
+  M->rows = A ? bmat_arena_alloc(A, rsize) : malloc(rsize);
+  if ((!M->data) || (!M->rows))
+    ERROR("memory allocation failed!\n");
+  memset(M->data, 0, size);
+  for(int i = 0; i < nrows; i++)
+    M->rows[i] = M->data + (size_t) i * M->width;
+  return M;
+}
+
+bmat_t * bmat_init(const int nrows, const int ncols){
+  return bmat_init_arena(NULL, nrows, ncols);
+}
+
+bmat_t * bmat_free(bmat_t *M){
+  if (M && !M->arena){
+    free(M->rows);
+    free(M->data);
+    free(M);
+  }
+  return NULL;
+}
+
+bmat_t * bmat_from_csr_perm(bmat_t *dst, const csr_t * const p, const mzp_t * const inv){
+  if ((dst->nrows != p->rows) || (dst->ncols != p->cols) || (inv->length != p->cols))
+    ERROR("Wrong size for return matrix.\n");
+  if (p->nz != -1)
+    ERROR("matrix should be in compressed form");
+  for(int i = 0; i < p->rows; i++){
+    word * const row = dst->rows[i];
+    memset(row, 0, sizeof(word) * dst->width);
+    for(int j = p->p[i]; j < p->p[i+1]; j++){
+      const rci_t col = inv->values[p->i[j]];
+      row[SETWD(col)] |= m4ri_one << SETBT(col);
+    }
+  }
+  return dst;
+}
+
+/** @brief in-place transpose of a 64 by 64 bit block, bit `j` of `a[i]` is `[i,j]` */
+static inline void transpose64(word a[64]){
+  word m = 0x00000000FFFFFFFFULL;
+  for(int j = 32; j != 0; j >>= 1, m ^= m << j){
+    for(int k = 0; k < 64; k = ((k | j) + 1) & ~j){
+      const word t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+
+bmat_t * bmat_transpose(bmat_t *dst, const bmat_t * const src){
+  if ((dst->nrows != src->ncols) || (dst->ncols != src->nrows))
+    ERROR("Wrong size for return matrix.\n");
+  word a[64];
+  const int rblk = (src->nrows + 63) / 64, cblk = (src->ncols + 63) / 64;
+  for(int I = 0; I < rblk; I++){
+    const int nr = minint_bmat(64, src->nrows - 64 * I);
+    for(int J = 0; J < cblk; J++){
+      for(int t = 0; t < 64; t++)
+	a[t] = (t < nr) ? src->rows[64 * I + t][J] : 0;
+      transpose64(a);
+      const int nc = minint_bmat(64, src->ncols - 64 * J);
+      for(int t = 0; t < nc; t++)
+	dst->rows[64 * J + t][I] = a[t];
+    }
+  }
+  return dst;
+}
+
+typedef struct {
+  bmat_t *dst;
+  const bmat_t *src;
+  const int *cols;
+} gather_arg_t;
+
+/** @brief rows `first...last-1` of `bmat_gather_cols()` */
+static void gather_cols(void * const arg, const int first, const int last, const int id){
+  const gather_arg_t * const g = arg;
+  bmat_t * const dst = g->dst;
+  const bmat_t * const src = g->src;
+  const int * const cols = g->cols;
+  (void) id;
+  word a[64];
+  const int rblk = (src->nrows + 63) / 64;
+  for(int beg = first, end; beg < last; beg = end){
+    const int J = SETWD(cols[beg]); /** columns `beg...end-1` are in word `J` */
+    for(end = beg + 1; (end < last) && (SETWD(cols[end]) == J); end++){}
+    for(int I = 0; I < rblk; I++){
+      const int nr = minint_bmat(64, src->nrows - 64 * I);
+      for(int t = 0; t < 64; t++)
+	a[t] = (t < nr) ? src->rows[64 * I + t][J] : 0;
+      transpose64(a);
+      for(int i = beg; i < end; i++)
+	dst->rows[i][I] = a[SETBT(cols[i])];
+    }
+  }
+}
+
+bmat_t * bmat_gather_cols_par(bmat_t *dst, const bmat_t * const src, const int * const cols, const int num,
+                              bmat_par_t * const par){
+  if ((dst->nrows < num) || (dst->ncols != src->nrows))
+    ERROR("Wrong size for return matrix.\n");
+  gather_arg_t g = {dst, src, cols};
+  /** a chunk of 64 columns is one block of `src` if the columns are dense */
+  bmat_par_run(par, gather_cols, &g, num, 64);
+  return dst;
+}
+
+bmat_t * bmat_gather_cols(bmat_t *dst, const bmat_t * const src, const int * const cols, const int num){
+  return bmat_gather_cols_par(dst, src, cols, num, NULL);
+}
+
+word * bmat_echelon_tab(const bmat_t * const M){
+  /** table of `2^M4RI_RW_K` rows, then one window word per row */
+  const size_t nwin = (M->nrows + BMAT_PAD - 1) / BMAT_PAD * BMAT_PAD; /** size a multiple of 64 bytes */
+  const size_t size = sizeof(word) * (((size_t) M->width << M4RI_RW_K) + nwin + BMAT_PAD);
+  word *tab = M->arena ? bmat_arena_alloc(M->arena, size) : aligned_alloc(64, size);
+  if (!tab)
+    ERROR("memory allocation failed!\n");
+  return tab;
+}
+
+/**
+ * Same algorithm as `mzd_echelon_m4ri()`.  In each block of `kk`
+ * columns the pivots are searched in the packed array `win` of row
+ * windows; the windows (but not the rows) of the remaining rows are
+ * cleared lazily.  A row chosen as a pivot is reduced by the previous
+ * pivot rows, which are then cleared in the new pivot column.  All
+ * other rows are reduced with one lookup in the table of `2^kbar`
+ * combinations of the pivot rows, using the original row bits.
+ */
+typedef struct {
+  bmat_t *M;
+  const word *tab;
+  int r, kbar, c, beg, len;
+} echelon_arg_t;
+
+/** @brief rows `first...last-1`, except the pivot rows, reduced with the table */
+static void echelon_rows(void * const arg, const int first, const int last, const int id){
+  const echelon_arg_t * const e = arg;
+  (void) id;
+  for(int i = first; i < last; i++){
+    if ((i >= e->r) && (i < e->r + e->kbar)) /** skip the pivot rows */
+      continue;
+    const word x = bmat_read_bits(e->M, i, e->c, e->kbar);
+    if (x)
+      bmat_xor(e->M->rows[i] + e->beg, e->tab + x * e->len, e->len);
+  }
+}
+
+/** rows reduced with the table per chunk of a parallel `bmat_echelon_par()` */
+#define BMAT_PAR_ROWS 256
+
+int bmat_echelon(bmat_t *M, mzp_t *q, word * const tab){
+  return bmat_echelon_par(M, q, tab, NULL);
+}
+
+int bmat_echelon_par(bmat_t *M, mzp_t *q, word * const tab, bmat_par_t * const par){
+  const int nrows = M->nrows, ncols = M->ncols, width = M->width;
+  word * const win = tab + ((size_t) width << M4RI_RW_K);
+  word ** const rows = M->rows;
+  int k = 1; /** table size `~nrows/4`, as in m4ri */
+  while ((k < M4RI_RW_K) && ((4 << k) <= nrows))
+    k++;
+  int r = 0, c = 0;
+  while((c < ncols) && (r < nrows)){
+    const int kk = minint_bmat(k, ncols - c);
+    const int beg = SETWD(c), len = width - beg;
+    for(int i = r; i < nrows; i++)
+      win[i] = bmat_read_bits(M, i, c, kk);
+    int kbar = 0;
+    for(int j = 0; j < kk; j++){
+      const word mask = (m4ri_one << (j + 1)) - 1;
+      int found = -1;
+      for(int i = r + kbar; i < nrows; i++){
+	word x = win[i];
+	if (x & mask){
+	  for(int l = 0; l < kbar; l++) /** lazy clear of the window only */
+	    if ((x >> l) & 1)
+	      x ^= win[r + l];
+	  win[i] = x;
+	  if ((x >> j) & 1){
+	    found = i;
+	    break;
+	  }
+	}
+      }
+      if (found < 0)
+	break;
+      const int ip = r + kbar;
+      bmat_row_swap(M, ip, found);
+      const word tmp = win[ip]; win[ip] = win[found]; win[found] = tmp;
+      word * const prow = rows[ip];
+      const word x0 = bmat_read_bits(M, ip, c, kbar + 1);
+      for(int l = 0; l < kbar; l++) /** reduce the new pivot row */
+	if ((x0 >> l) & 1)
+	  bmat_xor(prow + beg, rows[r + l] + beg, len);
+      for(int l = 0; l < kbar; l++) /** clear above in this block */
+	if ((win[r + l] >> j) & 1){
+	  bmat_xor(rows[r + l] + beg, prow + beg, len);
+	  win[r + l] ^= win[ip];
+	}
+      kbar++;
+    }
+    if (kbar){
+      /** table of all combinations of pivot rows `r...r+kbar-1` */
+      memset(tab, 0, sizeof(word) * len);
+      for(word x = 1; x < ((word) 1 << kbar); x++)
+	bmat_xor3(tab + x * len, tab + (x & (x - 1)) * len, rows[r + FIRSTBIT(x)] + beg, len);
+      echelon_arg_t e = {M, tab, r, kbar, c, beg, len};
+      if (par)
+	bmat_par_run(par, echelon_rows, &e, nrows, BMAT_PAR_ROWS);
+      else
+	echelon_rows(&e, 0, nrows, 0);
+      for(int j = 0; j < kbar; j++)
+	q->values[r + j] = c + j;
+      r += kbar;
+    }
+    /** `kbar < kk`: column `c+kbar` is known to be a non-pivot one */
+    c += kbar + (kbar < kk ? 1 : 0);
+  }
+  return r;
+}
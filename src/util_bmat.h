@@ -0,0 +1,215 @@
+#ifndef UTIL_BMAT_H
+#define UTIL_BMAT_H
+
+/************************************************************************
+ * @file util_bmat.h
+ * @brief packed binary matrices with a row index table for the RW
+ * elimination kernel; row XOR with AVX2 / AVX-512 chosen at run time
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** row length is padded to a multiple of this many words (one AVX-512 register) */
+#define BMAT_PAD 8
+
+/** size of a regular arena block, bytes */
+#define BMAT_ARENA_BLK (1 << 20)
+/** arena blocks at least this large are aligned for (and advised to use) huge pages */
+#define BMAT_HUGE (1 << 21)
+
+/**
+ * @brief Arena for the matrices and work space of one thread: 64-byte
+ * aligned chunks cut from large blocks, all released at once by
+ * `bmat_arena_free()`.  An arena is used by one thread only, so there
+ * is no locking, and M4RI's (not thread-safe) memory cache is not used.
+ */
+typedef struct {
+  char **blk;    /* blocks, the last one is being filled */
+  int nblk;
+  size_t used;   /* bytes used in the last block */
+  size_t size;   /* size of the last block */
+} bmat_arena_t;
+
+/**
+ * @brief Packed binary matrix; rows are accessed through a table of
+ * row pointers, so that a row swap is a pointer swap.
+ */
+typedef struct {
+  int nrows;
+  int ncols;
+  int width;     /* words per row, padded to a multiple of `BMAT_PAD` */
+  word *data;    /* `nrows*width` words, 64-byte aligned */
+  word **rows;   /* row `i` starts at `rows[i]` */
+  bmat_arena_t *arena; /* memory owner, or NULL if allocated with `malloc()` */
+} bmat_t;
+
+/** @brief body of a parallel loop, indices `[beg, end)`; `id` is the
+    calling thread, `0...nthreads-1` */
+typedef void (*bmat_par_fn)(void *arg, const int beg, const int end, const int id);
+
+/**
+ * @brief Parallel loop provided by the caller: `run()` calls `fun()`
+ * on disjoint ranges of at most `chunk` indices covering `[0, num)`,
+ * possibly from several threads, and returns when all calls are done.
+ */
+typedef struct BMAT_PAR_T {
+  void (*run)(struct BMAT_PAR_T *par, bmat_par_fn fun, void *arg, const int num, const int chunk);
+  int nthreads;
+} bmat_par_t;
+
+/** @brief run the loop with `par`, or in the calling thread if `par` is NULL */
+static inline void bmat_par_run(bmat_par_t * const par, bmat_par_fn fun, void * const arg,
+                                const int num, const int chunk){
+  if (par)
+    par->run(par, fun, arg, num, chunk);
+  else if (num > 0)
+    fun(arg, 0, num, 0);
+}
+
+/** @brief `dst[0...n-1] ^= src[0...n-1]`; SIMD version chosen at run time */
+extern void (*bmat_xor)(word * const dst, const word * const src, const size_t n);
+
+/** @brief `dst[0...n-1] = a[0...n-1] ^ b[0...n-1]`; SIMD version chosen at run time */
+extern void (*bmat_xor3)(word * const dst, const word * const a, const word * const b, const size_t n);
+
+/** @brief name of the row `XOR` kernel selected for this CPU */
+const char * bmat_kernel_name(void);
+
+/**
+ * @brief Allocate a zero matrix.
+ * @param nrows Number of rows.
+ * @param ncols Number of columns.
+ * @return Newly allocated matrix, free with `bmat_free()`.
+ */
+bmat_t * bmat_init(const int nrows, const int ncols);
+
+/** @brief free the matrix (unless it is in an arena), return NULL */
+bmat_t * bmat_free(bmat_t *M);
+
+/** @brief new empty arena, free with `bmat_arena_free()` */
+bmat_arena_t * bmat_arena_init(void);
+
+/** @brief free the arena with everything allocated in it, return NULL */
+bmat_arena_t * bmat_arena_free(bmat_arena_t *A);
+
+/** @brief `size` bytes from the arena, 64-byte aligned, not initialized */
+void * bmat_arena_alloc(bmat_arena_t *A, const size_t size);
+
+/** @brief zero matrix allocated in the arena `A` (with `malloc()` if `A` is NULL) */
+bmat_t * bmat_init_arena(bmat_arena_t *A, const int nrows, const int ncols);
+
+/** @brief identity permutation of the given length allocated in the arena */
+mzp_t * bmat_arena_perm(bmat_arena_t *A, const rci_t length);
+
+/** @brief row `i` of the matrix */
+static inline word * bmat_row(const bmat_t * const M, const int i){
+  return M->rows[i];
+}
+
+/** @brief read bit `M[i,col]` */
+static inline int bmat_read_bit(const bmat_t * const M, const int i, const int col){
+  return (M->rows[i][SETWD(col)] >> SETBT(col)) & 1;
+}
+
+/** @brief return `n<=64` bits `[col, col+n)` of row `i` as a word */
+static inline word bmat_read_bits(const bmat_t * const M, const int i, const int col, const int n){
+  const word * const row = M->rows[i];
+  const int spot = SETBT(col);
+  const int blk = SETWD(col);
+  word w = row[blk] >> spot;
+  if (spot + n > m4ri_radix)
+    w |= row[blk + 1] << (m4ri_radix - spot);
+  return w & (m4ri_ffff >> (m4ri_radix - n));
+}
+
+/** @brief swap rows `i` and `j` (pointer swap) */
+static inline void bmat_row_swap(bmat_t * const M, const int i, const int j){
+  word * const tmp = M->rows[i];
+  M->rows[i] = M->rows[j];
+  M->rows[j] = tmp;
+}
+
+/**
+ * @brief Convert a CSR sparse matrix to a packed matrix with permuted columns.
+ *
+ * Column `c` of `p` becomes column `inv->values[c]` of `dst`.
+ *
+ * @param dst Destination matrix (must have correct dimensions).
+ * @param p Source sparse matrix (compressed form).
+ * @param inv Column permutation.
+ * @return Pointer to the destination matrix.
+ */
+bmat_t * bmat_from_csr_perm(bmat_t *dst, const csr_t * const p, const mzp_t * const inv);
+
+/**
+ * @brief Transpose with 64 by 64 blocks, `dst = src^T`.
+ * @param dst Destination matrix, `src->ncols` by `src->nrows`.
+ * @param src Source matrix.
+ * @return Pointer to the destination matrix.
+ */
+bmat_t * bmat_transpose(bmat_t *dst, const bmat_t * const src);
+
+/**
+ * @brief Gather selected columns of `src` as rows of `dst`.
+ *
+ * Row `i` of `dst` is set to column `cols[i]` of `src`, for `i<num`;
+ * only the 64 by 64 blocks of `src` containing these columns are
+ * transposed.
+ *
+ * @param dst Destination matrix, at least `num` rows and `src->nrows` columns.
+ * @param src Source matrix.
+ * @param cols Columns to gather, increasing.
+ * @param num Number of columns.
+ * @return Pointer to the destination matrix.
+ */
+bmat_t * bmat_gather_cols(bmat_t *dst, const bmat_t * const src, const int * const cols, const int num);
+
+/** @brief `bmat_gather_cols()` with the columns split over the threads of `par` (may be NULL) */
+bmat_t * bmat_gather_cols_par(bmat_t *dst, const bmat_t * const src, const int * const cols, const int num,
+                              bmat_par_t * const par);
+
+/**
+ * @brief Allocate the work space used by `bmat_echelon()` for matrix M.
+ * @param M Matrix to be reduced.
+ * @return Buffer in the arena of `M`, or one to free with `free()`.
+ */
+word * bmat_echelon_tab(const bmat_t * const M);
+
+/**
+ * @brief Reduced row echelon form with the Method of Four Russians.
+ *
+ * Same pivots as `mzd_echelon_m4ri()`, i.e., greedy left to right.
+ * Pivot rows are found by scanning a packed array of `M4RI_RW_K`-bit
+ * row windows; row swaps are pointer swaps, and row additions use
+ * the SIMD `bmat_xor()` kernels.
+ *
+ * @param M Matrix to reduce (modified in place).
+ * @param q Pivot columns are stored in `q->values[0...rank-1]` (increasing).
+ * @param tab Work space from `bmat_echelon_tab()`.
+ * @return Rank of the matrix.
+ */
+int bmat_echelon(bmat_t *M, mzp_t *q, word * const tab);
+
+/**
+ * @brief `bmat_echelon()` with the row additions from the table split
+ * over the threads of `par` by row blocks; the pivot search is serial.
+ * Same result as `bmat_echelon()`; `par` may be NULL.
+ */
+int bmat_echelon_par(bmat_t *M, mzp_t *q, word * const tab, bmat_par_t * const par);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTIL_BMAT_H */
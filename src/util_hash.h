@@ -34,7 +34,7 @@ extern "C"{
   } two_vec_t;
 
   struct CW_VEC_T {
-    UT_hash_handle hh;
+    long long seq; /** insertion order, used for output */
     int weight;
     int cnt;
     int arr[0];
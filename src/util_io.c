@@ -16,6 +16,10 @@ params_t prm={
   .dmax=0,
   .wmin=1,
   .noscan=0,
+  .ccpass=0,
+  .ccbranch=0,
+  .ccmitm=0,
+  .ccmem=0,
   .fdem=NULL,
   .pmin=0.0,
   .start=-1, 
@@ -31,12 +35,14 @@ params_t prm={
   .nvar=0,
   .nchk=0,
   .maxC=0,
+  .cw_cap=0,
   .dW=0,
   .finC=NULL,
   .outC=NULL,
-  .codewords=NULL,
   .num_cws=0,
+  .cw_seq=0,
   .min_w=INT_MAX,
+  .cw_keep_w=INT_MAX,
   .finH=NULL,
   .finG=NULL,
   .finL=NULL,
@@ -44,7 +50,18 @@ params_t prm={
   .spaH=NULL,
   .spaG=NULL,
   .spaL=NULL,
+  .maskL=NULL,
   .threads=0,
+  .affinity=0,
+  .mem=0,
+  .bz=-1,
+  .rwinc=0,
+  .rwsparse=-1,
+  .rwgroup=1,
+  .lb=1,
+  .isd=0,
+  .isdp=2,
+  .isdl=0,
   .dexp=0,
   .timeout=60.0
 };
@@ -57,6 +74,15 @@ void var_init(int argc, char **argv, params_t * const p){
   double prob=0.0;
   long long int dbg_ll=0;
 
+  for(int i=0; i < CW_SHARDS; i++){
+    pthread_mutex_init(&p->codewords[i].lock, NULL);
+    p->codewords[i].tab = NULL;
+    p->codewords[i].mask = 0;
+    p->codewords[i].used = 0;
+    p->codewords[i].bkt = NULL;
+    p->codewords[i].nbkt = 0;
+  }
+
   if(argc <= 1)
     ERROR("no command-line arguments given, " BRIEF_HELP,argv[0]);
 
@@ -178,6 +204,51 @@ void var_init(int argc, char **argv, params_t * const p){
       if (p->debug&4)
 	fprintf(stderr, "# read %s, steps=%d\n",argv[i],p->steps);
     }
+    else if (sscanf(argv[i],"rwinc=%d",&dbg)==1){
+      p->rwinc=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, rwinc=%d\n",argv[i],p->rwinc);
+    }
+    else if (sscanf(argv[i],"rwsparse=%d",&dbg)==1){
+      p->rwsparse=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, rwsparse=%d\n",argv[i],p->rwsparse);
+    }
+    else if (sscanf(argv[i],"rwgroup=%d",&dbg)==1){
+      p->rwgroup=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, rwgroup=%d\n",argv[i],p->rwgroup);
+    }
+    else if (sscanf(argv[i],"bz=%d",&dbg)==1){
+      p->bz=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, bz=%d\n",argv[i],p->bz);
+    }
+    else if (sscanf(argv[i],"lb=%d",&dbg)==1){
+      p->lb=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, lb=%d\n",argv[i],p->lb);
+    }
+    else if (0==strncmp(argv[i],"isd=",4)){ /** `isd` */
+      if (0==strcmp(argv[i]+4,"prange"))
+	p->isd=0;
+      else if (0==strcmp(argv[i]+4,"stern"))
+	p->isd=1;
+      else
+	ERROR("unsupported %s, use isd=prange or isd=stern\n",argv[i]);
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, isd=%d\n",argv[i],p->isd);
+    }
+    else if (sscanf(argv[i],"isdp=%d",&dbg)==1){
+      p->isdp=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, isdp=%d\n",argv[i],p->isdp);
+    }
+    else if (sscanf(argv[i],"isdl=%d",&dbg)==1){
+      p->isdl=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, isdl=%d\n",argv[i],p->isdl);
+    }
     else if (sscanf(argv[i],"seed=%d",&dbg)==1){
       p->seed=dbg;
       if (p->debug&4)
@@ -188,6 +259,26 @@ void var_init(int argc, char **argv, params_t * const p){
       if (p->debug&4)
 	fprintf(stderr, "# read %s, noscan=%d\n",argv[i],p->noscan);
     }
+    else if (sscanf(argv[i],"ccpass=%d",&dbg)==1){
+      p->ccpass=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, ccpass=%d\n",argv[i],p->ccpass);
+    }
+    else if (sscanf(argv[i],"ccbranch=%d",&dbg)==1){
+      p->ccbranch=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, ccbranch=%d\n",argv[i],p->ccbranch);
+    }
+    else if (sscanf(argv[i],"ccmitm=%d",&dbg)==1){
+      p->ccmitm=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, ccmitm=%d\n",argv[i],p->ccmitm);
+    }
+    else if (sscanf(argv[i],"ccmem=%d",&dbg)==1){
+      p->ccmem=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, ccmem=%d\n",argv[i],p->ccmem);
+    }
     else if (0==strncmp(argv[i],"fdem=",5)){
       if(strlen(argv[i])>5)
         p->fdem = argv[i]+5;
@@ -237,6 +328,16 @@ void var_init(int argc, char **argv, params_t * const p){
       if (p->debug&4)
 	fprintf(stderr, "# read %s, threads=%d\n",argv[i],p->threads);
     }
+    else if (sscanf(argv[i],"affinity=%d",&dbg)==1){
+      p->affinity=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, affinity=%d\n",argv[i],p->affinity);
+    }
+    else if (sscanf(argv[i],"mem=%d",&dbg)==1){
+      p->mem=dbg;
+      if (p->debug&4)
+	fprintf(stderr, "# read %s, mem=%d\n",argv[i],p->mem);
+    }
     else if (sscanf(argv[i],"dexp=%d",&dbg)==1){
       p->dexp=dbg;
       if (p->debug&4)
@@ -314,7 +415,31 @@ void var_init(int argc, char **argv, params_t * const p){
   } else if (p->dmin > 1 && p->smax > 0) {
     fprintf(stderr, "# WARNING: smax=%d disabled (set to 0) because dmin=%d skips small cluster weights\n", p->smax, p->dmin);
     p->smax = 0;
+  } else if (p->ccmitm && p->smax > 0) {
+    fprintf(stderr, "# WARNING: smax=%d disabled (set to 0) because ccmitm=1 skips clusters above half weight\n", p->smax);
+    p->smax = 0;
+  } else if (p->ccbranch && p->smax > 0) {
+    fprintf(stderr, "# WARNING: smax=%d disabled (set to 0) because ccbranch=1 changes the clusters enumerated\n", p->smax);
+    p->smax = 0;
   }
+  if ((p->ccbranch < 0) || (p->ccbranch > 1))
+    ERROR("parameter ccbranch=%d should be 0 or 1", p->ccbranch);
+  if ((p->ccpass < 0) || (p->ccpass > 1))
+    ERROR("parameter ccpass=%d should be 0 or 1", p->ccpass);
+  if (p->ccpass) {
+    if ((p->method & 2) == 0)
+      ERROR("ccpass=1 only works with method=2 or method=3");
+    if (p->noscan)
+      ERROR("ccpass=1 can not be used with noscan=1");
+    if (p->wmax <= 0)
+      ERROR("ccpass=1 needs wmax>0, the weight of the pass");
+  }
+  if ((p->ccmitm < 0) || (p->ccmitm > 1))
+    ERROR("parameter ccmitm=%d should be 0 or 1", p->ccmitm);
+  if (p->ccmem < 0)
+    ERROR("parameter ccmem=%d should be non-negative", p->ccmem);
+  if (p->rwinc < 0)
+    ERROR("parameter rwinc=%d should be non-negative", p->rwinc);
 
   if (p->method == 2) {
     if (p->steps != 1000) {
@@ -325,6 +450,12 @@ void var_init(int argc, char **argv, params_t * const p){
   if(p->method &1 ){ /* RW */
     if (p->steps<=0)
       ERROR("parameter steps=%d should be positive for RW method=%d", p->steps,p->method);
+    if ((p->lb < 1) || (p->lb > ISD_MAX_P))
+      ERROR("parameter lb=%d should be in the range 1...%d", p->lb, ISD_MAX_P);
+    if ((p->isdp < 1) || (p->isdp > ISD_MAX_P))
+      ERROR("parameter isdp=%d should be in the range 1...%d", p->isdp, ISD_MAX_P);
+    if ((p->isdl < 0) || (p->isdl > ISD_MAX_L))
+      ERROR("parameter isdl=%d should be in the range 0...%d", p->isdl, ISD_MAX_L);
   }
   
 
@@ -400,6 +531,19 @@ void var_init(int argc, char **argv, params_t * const p){
     }
   }
 
+  if ((p->bz < -1) || (p->bz > 1))
+    ERROR("parameter bz=%d should be -1 (auto), 0, or 1", p->bz);
+  if ((p->rwsparse < -1) || (p->rwsparse > 1))
+    ERROR("parameter rwsparse=%d should be -1 (auto), 0, or 1", p->rwsparse);
+  if (p->rwgroup < 1)
+    ERROR("parameter rwgroup=%d should be positive", p->rwgroup);
+  if ((p->rwgroup > 1) && (p->rwsparse == 1))
+    ERROR("parameter rwgroup=%d needs dense elimination, use rwsparse=0 or -1", p->rwgroup);
+  if ((p->affinity < 0) || (p->affinity > 2))
+    ERROR("parameter affinity=%d should be 0, 1, or 2", p->affinity);
+  if (p->mem < 0)
+    ERROR("parameter mem=%d should be non-negative", p->mem);
+
   if(p->method & 2){ /* CC */
     if ((p->wmax<=0) && ((p->method & 1 )==0)) {
       if (p->timeout <= 0.0) {
@@ -463,6 +607,9 @@ void var_init(int argc, char **argv, params_t * const p){
     }
   }
 
+  if (p->spaL)
+    p->maskL = csr_colmask_init(p->spaL);
+
   if ((p->method <= 0) || (p->method > 3)){
       printf("invalid method=%d specified\n", p->method);
       ERROR(BRIEF_HELP,argv[0]);
@@ -470,7 +617,10 @@ void var_init(int argc, char **argv, params_t * const p){
   
 }
 
+static void cw_bucket_free(cw_bucket_t * const b);
+
 void var_kill(params_t * const p){
+  p->maskL = csr_colmask_free(p->maskL);
   if(p->spaL)
     csr_free(p->spaL);
   if(p->spaH)
@@ -488,10 +638,13 @@ void var_kill(params_t * const p){
     }
   }
 
-  cw_vec_t *cw, *tmp;
-  HASH_ITER(hh, p->codewords, cw, tmp) {
-    HASH_DEL(p->codewords, cw);
-    free(cw);
+  for(int i=0; i < CW_SHARDS; i++){
+    cw_shard_t * const sh = &p->codewords[i];
+    for(int w=0; w < sh->nbkt; w++)
+      cw_bucket_free(&sh->bkt[w]);
+    free(sh->bkt);
+    free(sh->tab);
+    pthread_mutex_destroy(&sh->lock);
   }
 }
 
@@ -794,47 +947,220 @@ cw_vec_t * nzlist_r_one(FILE *f, cw_vec_t * vec, const char fnam[], long long in
   return vec;
 }
 
-cw_vec_t * codeword_add_maybe(params_t * const p, const int arr[], int weight) {
-  if (p->maxC && p->num_cws >= p->maxC) {
-    return p->codewords;
+/** @brief largest weight of interest given the minimum weight `min_w` */
+static inline int codeword_max_w(const params_t * const p, const int min_w){
+  return (min_w == INT_MAX) ? INT_MAX : ((p->dW >= 0) ? (min_w + p->dW) : min_w);
+}
+
+/** @brief bytes per codeword of weight `w` in a bucket */
+static inline size_t cw_stride(const int w){
+  return (sizeof(cw_vec_t) + w * sizeof(int) + 7) & ~(size_t) 7;
+}
+
+/** @brief number of places in arena block `j` */
+static inline int cw_blk_cap(const int j){
+  return (j < 20) ? minint(CW_BLK_MIN << j, CW_BLK_MAX) : CW_BLK_MAX;
+}
+
+/** @brief a new place in the bucket for a codeword of weight `w` */
+static cw_vec_t * cw_bucket_new(cw_bucket_t * const b, const int w){
+  if (b->left == 0){
+    b->blk = realloc(b->blk, sizeof(char *) * (b->nblk + 1));
+    if (!b->blk) ERROR("memory allocation");
+    b->left = cw_blk_cap(b->nblk);
+    b->blk[b->nblk] = malloc(cw_stride(w) * b->left);
+    if (!b->blk[b->nblk]) ERROR("memory allocation");
+    b->nblk++;
   }
-  // Check if weight is within the current limit: min_w + dW (or min_w if dW < 0)
-  int max_allowed_w = (p->min_w == INT_MAX) ? INT_MAX : ((p->dW >= 0) ? (p->min_w + p->dW) : p->min_w);
-  if (weight > max_allowed_w) {
-    return p->codewords;
+  const int j = b->nblk - 1;
+  cw_vec_t * const cw = (cw_vec_t *) (b->blk[j] + cw_stride(w) * (cw_blk_cap(j) - b->left));
+  b->left--;
+  b->num++;
+  return cw;
+}
+
+/** @brief free all codewords in the bucket at once */
+static void cw_bucket_free(cw_bucket_t * const b){
+  for(int j=0; j < b->nblk; j++)
+    free(b->blk[j]);
+  free(b->blk);
+  b->blk = NULL;
+  b->nblk = 0;
+  b->left = 0;
+  b->num = 0;
+}
+
+/** @brief rebuild the index with room for at least `4*live` slots, dropping dead slots */
+static void cw_shard_rehash(cw_shard_t * const sh, const int limit){
+  size_t live = 0;
+  for(size_t i=0; sh->tab && i <= sh->mask; i++)
+    if (sh->tab[i].cw && sh->tab[i].weight <= limit)
+      live++;
+  size_t size = 64;
+  while (size < 4 * live)
+    size <<= 1;
+  cw_slot_t * const tab = calloc(size, sizeof(cw_slot_t));
+  if (!tab) ERROR("memory allocation");
+  for(size_t i=0; sh->tab && i <= sh->mask; i++){
+    const cw_slot_t * const s = &sh->tab[i];
+    if (s->cw && s->weight <= limit){
+      size_t j = s->hash & (size - 1);
+      while (tab[j].cw)
+        j = (j + 1) & (size - 1);
+      tab[j] = *s;
+    }
   }
+  free(sh->tab);
+  sh->tab = tab;
+  sh->mask = size - 1;
+  sh->used = live;
+}
 
-  const size_t keylen = weight * sizeof(int);
-  cw_vec_t *pvec = NULL;
-  HASH_FIND(hh, p->codewords, arr, keylen, pvec);
-  if (!pvec) {
-    cw_vec_t *entry = malloc(sizeof(cw_vec_t) + keylen);
-    if (!entry) ERROR("memory allocation");
-    entry->weight = weight;
-    entry->cnt = 1;
-    for (int i = 0; i < weight; i++) {
-      entry->arr[i] = arr[i];
-    }
-    HASH_ADD(hh, p->codewords, arr, keylen, entry);
-    p->num_cws++;
-    
-    // Update min_w and prune heavier codewords
-    if (weight < p->min_w) {
-      p->min_w = weight;
-      int prune_w = (p->dW >= 0) ? (p->min_w + p->dW) : p->min_w;
-      cw_vec_t *cw, *tmp;
-      HASH_ITER(hh, p->codewords, cw, tmp) {
-        if (cw->weight > prune_w) {
-          HASH_DEL(p->codewords, cw);
-          free(cw);
-          p->num_cws--;
-        }
+/** @brief largest weight kept in the store, see `codeword_max_w()` and `cw_keep_w` */
+static inline int codeword_limit(params_t * const p){
+  return minint(codeword_max_w(p, atomic_load(&p->min_w)), atomic_load(&p->cw_keep_w));
+}
+
+/** @brief drop the buckets of codewords heavier than `codeword_limit()`, one shard at a time;
+    their index slots become dead and are reused or dropped on rehash */
+static void codeword_prune(params_t * const p){
+  for (int j = 0; j < CW_SHARDS; j++) {
+    cw_shard_t * const s = &p->codewords[j];
+    pthread_mutex_lock(&s->lock);
+    const int prune_w = codeword_limit(p);
+    for (int w = prune_w + 1; w < s->nbkt; w++) {
+      if (s->bkt[w].num) {
+        atomic_fetch_sub(&p->num_cws, s->bkt[w].num);
+        cw_bucket_free(&s->bkt[w]);
       }
     }
-  } else {
-    pvec->cnt++;
+    pthread_mutex_unlock(&s->lock);
   }
-  return p->codewords;
+}
+
+/** @brief the store is full (`cw_cap`): drop the heaviest codewords if they are heavier than `weight`
+    @return 1 if some room may have been made, 0 otherwise */
+static int codeword_evict(params_t * const p, const int weight){
+  int max_w = 0;
+  for (int j = 0; j < CW_SHARDS; j++) {
+    cw_shard_t * const s = &p->codewords[j];
+    pthread_mutex_lock(&s->lock);
+    for (int w = s->nbkt - 1; w > max_w; w--) {
+      if (s->bkt[w].num) {
+        max_w = w;
+        break;
+      }
+    }
+    pthread_mutex_unlock(&s->lock);
+  }
+  if (max_w <= weight)
+    return 0;
+  atomic_min_int(&p->cw_keep_w, max_w - 1);
+  codeword_prune(p);
+  return 1;
+}
+
+int codeword_add_maybe(params_t * const p, const int arr[], int weight) {
+  /** quick checks without a lock, repeated below */
+  if (p->maxC && atomic_load(&p->num_cws) >= p->maxC) {
+    return 0;
+  }
+  /** a new minimum weight: drop heavier codewords first, so that a full store does not keep it out */
+  if (atomic_min_int(&p->min_w, weight)) {
+    codeword_prune(p);
+  }
+  if (weight > codeword_limit(p)) {
+    return 0;
+  }
+  while (p->cw_cap && atomic_load(&p->num_cws) >= p->cw_cap) {
+    if (!codeword_evict(p, weight))
+      return 0;
+  }
+
+  const size_t keylen = weight * sizeof(int);
+  unsigned hashv;
+  HASH_VALUE(arr, keylen, hashv);
+  /** high bits of `hashv` select the shard, low bits the index slot */
+  cw_shard_t * const sh = &p->codewords[hashv >> (32 - CW_SHARD_BITS)];
+  pthread_mutex_lock(&sh->lock);
+  const int limit = codeword_limit(p);
+  if (weight > limit) {
+    pthread_mutex_unlock(&sh->lock);
+    return 0;
+  }
+  if (2 * (sh->used + 1) > sh->mask + 1)
+    cw_shard_rehash(sh, limit);
+  cw_slot_t *slot = NULL; /** first dead slot on the way, if any */
+  size_t i = hashv & sh->mask;
+  for (; sh->tab[i].cw; i = (i + 1) & sh->mask) {
+    cw_slot_t * const s = &sh->tab[i];
+    if (s->weight > limit) {
+      if (!slot)
+        slot = s;
+    }
+    else if ((s->hash == hashv) && (s->weight == weight) && (memcmp(s->cw->arr, arr, keylen) == 0)) {
+      /** same as before: duplicates are not counted once `maxC` is reached */
+      if (!(p->maxC && atomic_load(&p->num_cws) >= p->maxC))
+        s->cw->cnt++;
+      pthread_mutex_unlock(&sh->lock);
+      return 0;
+    }
+  }
+  /** reserve a place; `cw_cap` may be exceeded by one codeword per thread
+      rather than evict under the shard lock */
+  const long long int num = atomic_fetch_add(&p->num_cws, 1);
+  if (p->maxC && num >= p->maxC) {
+    atomic_fetch_sub(&p->num_cws, 1);
+    pthread_mutex_unlock(&sh->lock);
+    return 0;
+  }
+  if (weight >= sh->nbkt) {
+    sh->bkt = realloc(sh->bkt, sizeof(cw_bucket_t) * (weight + 1));
+    if (!sh->bkt) ERROR("memory allocation");
+    memset(sh->bkt + sh->nbkt, 0, sizeof(cw_bucket_t) * (weight + 1 - sh->nbkt));
+    sh->nbkt = weight + 1;
+  }
+  cw_vec_t * const entry = cw_bucket_new(&sh->bkt[weight], weight);
+  entry->seq = atomic_fetch_add(&p->cw_seq, 1);
+  entry->weight = weight;
+  entry->cnt = 1;
+  memcpy(entry->arr, arr, keylen);
+  if (!slot) {
+    slot = &sh->tab[i];
+    sh->used++;
+  }
+  slot->hash = hashv;
+  slot->weight = weight;
+  slot->cw = entry;
+  pthread_mutex_unlock(&sh->lock);
+  return 1;
+}
+
+static int by_seq(const void *a, const void *b){
+  const long long sa = (*(cw_vec_t * const *) a)->seq;
+  const long long sb = (*(cw_vec_t * const *) b)->seq;
+  return (sa > sb) - (sa < sb);
+}
+
+cw_vec_t ** codeword_list(params_t * const p, long long int *num){
+  long long int cnt = 0;
+  for (int i = 0; i < CW_SHARDS; i++)
+    for (int w = 0; w < p->codewords[i].nbkt; w++)
+      cnt += p->codewords[i].bkt[w].num;
+  cw_vec_t **list = malloc(sizeof(cw_vec_t *) * (cnt + 1));
+  if (!list) ERROR("memory allocation");
+  cnt = 0;
+  for (int i = 0; i < CW_SHARDS; i++)
+    for (int w = 0; w < p->codewords[i].nbkt; w++) {
+      const cw_bucket_t * const b = &p->codewords[i].bkt[w];
+      long long int left = b->num;
+      for (int j = 0; j < b->nblk; j++)
+        for (int t = 0; (t < cw_blk_cap(j)) && (left > 0); t++, left--)
+          list[cnt++] = (cw_vec_t *) (b->blk[j] + cw_stride(w) * t);
+    }
+  qsort(list, cnt, sizeof(cw_vec_t *), by_seq);
+  *num = cnt;
+  return list;
 }
 
 long long int nzlist_read(const char fnam[], params_t *p){
@@ -850,6 +1176,10 @@ long long int nzlist_read(const char fnam[], params_t *p){
     else
       return 0;
   }
+  /** bit-packed columns of `H` unless too large; `L` is already there */
+  csr_colmask_t *maskH = NULL;
+  if ((p->spaH) && ((long long) p->spaH->cols * ((p->spaH->rows + 63) / 64) <= NZLIST_MAX_MASK))
+    maskH = csr_colmask_init(p->spaH);
   cw_vec_t *entry=NULL;
   while((entry=nzlist_r_one(f,NULL, fnam, &lineno))){
     if((p->maxC) && (p->num_cws >= p->maxC)) {
@@ -857,13 +1187,18 @@ long long int nzlist_read(const char fnam[], params_t *p){
       break;
     }
     int valid = 1;
-    if (p->spaH) {
+    if (maskH) {
+      if (colmask_syndrome_non_zero(maskH, entry->weight, entry->arr)) {
+        valid = 0;
+      }
+    }
+    else if (p->spaH) {
       if (sparse_syndrome_non_zero(p->spaH, entry->weight, entry->arr)) {
         valid = 0;
       }
     }
-    if (valid && p->spaL) {
-      if (!sparse_syndrome_non_zero(p->spaL, entry->weight, entry->arr)) {
+    if (valid && p->maskL) {
+      if (!colmask_syndrome_non_zero(p->maskL, entry->weight, entry->arr)) {
         valid = 0;
       }
     }
@@ -873,15 +1208,12 @@ long long int nzlist_read(const char fnam[], params_t *p){
       continue;
     }
     if((p->wmax==0) ||((p->wmax) && (entry->weight <= p->wmax))){
-      long long int old_num = p->num_cws;
-      p->codewords = codeword_add_maybe(p, entry->arr, entry->weight);
-      if (p->num_cws > old_num) {
-        count++;
-      }
+      count += codeword_add_maybe(p, entry->arr, entry->weight);
     }
     free(entry);
   }
   fclose(f);
+  csr_colmask_free(maskH);
   if (skipped_invalid > 0) {
     fprintf(stderr, "# Warning: skipped %lld invalid codewords (not orthogonal to H or orthogonal to L)\n", skipped_invalid);
   }
@@ -894,12 +1226,13 @@ long long int nzlist_write(const char fnam[], const char comment[], params_t *p)
   long long int count=0;
   assert(fnam);
   FILE * f = nzlist_w_new(fnam, comment);
-  cw_vec_t *pvec;
-  
-  for(pvec = p->codewords; pvec != NULL; pvec = (cw_vec_t *)(pvec->hh.next)){
+  long long int num;
+  cw_vec_t **list = codeword_list(p, &num);
+  for(long long int i = 0; i < num; i++){
     count ++;
-    nzlist_w_append(f,pvec);
+    nzlist_w_append(f,list[i]);
   }
+  free(list);
   fclose(f);
   return count;
 }
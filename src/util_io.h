@@ -14,6 +14,8 @@
 #include <time.h>
 #include <stdio.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <m4ri/m4ri.h>
 
 #include "mmio.h"
@@ -26,14 +28,56 @@
 //static const int max_row_wt=10; 
 
 #define MAX_W 100 
+#define ISD_MAX_P 4  /** max subset size `isdp` for Stern's algorithm and `lb` for Lee-Brickell */
+#define ISD_MAX_L 24 /** max window size `isdl` for Stern's algorithm */
+#define NZLIST_MAX_MASK (1LL << 24) /** max words of `H` column masks for checking codewords read by `nzlist_read()` */
+#define CW_SHARD_BITS 6 /** the codeword store has `2^CW_SHARD_BITS` independently locked parts */
+#define CW_SHARDS (1 << CW_SHARD_BITS)
+#define CW_BLK_MIN 8     /** codewords in the first arena block of a bucket */
+#define CW_BLK_MAX 8192  /** max codewords per arena block */
 struct CW_VEC_T;
 typedef struct CW_VEC_T cw_vec_t;
+
+/** @brief codewords of one weight in one shard, stored in an arena;
+    block `j` has room for `min(CW_BLK_MIN<<j, CW_BLK_MAX)` codewords */
+typedef struct {
+  char **blk;
+  int nblk;
+  int left;      /* free places in the last block */
+  long long num; /* number of codewords */
+} cw_bucket_t;
+
+/** @brief slot of the open-addressing index; empty if `cw==NULL`,
+    dead if `weight` is above the current limit (bucket pruned) */
+typedef struct {
+  unsigned hash;
+  int weight;
+  cw_vec_t *cw;
+} cw_slot_t;
+
+/** @brief one part of the codeword store, with its own lock */
+typedef struct {
+  pthread_mutex_t lock;
+  cw_slot_t *tab;   /* index, `mask+1` slots (power of 2) */
+  size_t mask;
+  size_t used;      /* non-empty slots, including dead ones */
+  cw_bucket_t *bkt; /* buckets by weight, `0...nbkt-1` */
+  int nbkt;
+} cw_shard_t;
+
 typedef struct{
   int debug; /* debug information */ 
   int classical; /* 1 for a classical code, i.e., no `G=Hz` matrix*/
   int css; /* 1: css, 0: non-css -- currently not supported */
   int method; /* bitmap. 1: random window; 2: cluster; 3: both */
   int steps; /* how many RW decoding steps */
+  int rwinc; /** RW: pivot swaps per incremental step (0: full elimination every step) */
+  int rwsparse; /** RW: 1 sparse elimination, 0 dense, -1 auto (sparse for large `H`) */
+  int rwgroup; /** RW: threads sharing one (dense) elimination, 1: each thread on its own */
+  int lb; /** RW: Lee-Brickell, try sums of up to `lb` dual rows (1: single rows only) */
+  int isd; /** RW: 0 for Prange (single dual rows), 1 for Stern collisions */
+  int isdp; /** Stern: subset size on each half of the information set */
+  int isdl; /** Stern: collision window size in bits (0: auto) */
   int smax; /** max syndrome weight of interest for `confinement`
 		calculation.  When `smax=0` (default), do not
 		calculate confinement or use hashing storage.
@@ -46,6 +90,10 @@ typedef struct{
 		start clusters with `wmin` for `CC`
 	     */
   int noscan; /** 1: start CC directly with wmax (no scan over w) */
+  int ccpass; /** CC: 1 to enumerate clusters of all weights up to `wmax` in one pass */
+  int ccbranch; /** CC: 0 to branch on the first unsatisfied row, 1 on the one with the fewest columns */
+  int ccmitm; /** CC: 1 to complete clusters from half weight with a table of second halves */
+  int ccmem; /** CC: MiB for the `ccmitm` tables of all threads (0: from the memory budget) */
   int seed;/* rng seed, set=0 for automatic */
   int dist; /* target distance of the code */
   int dist_max; /* distance actually checked */
@@ -62,12 +110,15 @@ typedef struct{
   int nvar; /* actual n = matrix size */
   int nchk; /* actual k = number of codewords */
   long long int maxC;
+  long long int cw_cap; /* codeword store limit from the memory budget (0: none), unlike `maxC` it does not change what is searched */
   int dW;
   char *finC;
   char *outC;
-  cw_vec_t *codewords;
-  long long int num_cws;
-  int min_w;
+  cw_shard_t codewords[CW_SHARDS]; /* codeword store, sharded by the hash of the support, bucketed by weight */
+  atomic_llong num_cws;
+  atomic_llong cw_seq; /* insertion counter, gives the order of `nzlist_write()` */
+  atomic_int min_w;
+  atomic_int cw_keep_w; /* heaviest codewords dropped to keep the store within `cw_cap` */
   char *fdem;
   double pmin;
   char *finH;
@@ -77,12 +128,25 @@ typedef struct{
   csr_t *spaH;
   csr_t *spaG;
   csr_t *spaL;
+  csr_colmask_t *maskL; /* bit-packed columns of `L` for the logical check, NULL if classical */
+  int bz; /** 1: Brouwer-Zimmermann instead of CC; 0: CC; -1: auto (BZ for dense `H` with method 3) */
   int threads; /* number of threads to use (0 for auto) */
+  int affinity; /* worker placement: 0 none, 1 spread over cores, 2 SMT pairs, see `util_sys.h` */
+  int mem; /* memory budget in MiB (0: cgroup limit or physical memory) */
   int dexp;    /* expected distance value (0 for auto/none) */
   double timeout; /* timeout in seconds (default 60.0) */
 } params_t;
 
 static inline int minint(const int a, const int b) { return (a < b) ? a : b; }
+
+/** @brief atomically set `*a=min(*a,v)`, return 1 if the value was lowered */
+static inline int atomic_min_int(atomic_int *a, const int v){
+  int cur = atomic_load(a);
+  while (v < cur)
+    if (atomic_compare_exchange_weak(a, &cur, v))
+      return 1;
+  return 0;
+}
 // #define MININT(a,b) do{ int t1=(a); int t2=(b); t1<t2? t1 :t2; } while(0)
 
 extern params_t prm;
@@ -148,19 +212,35 @@ long long int nzlist_read(const char fnam[], params_t *p);
 long long int nzlist_write(const char fnam[], const char comment[], params_t *p);
 
 /**
- * @brief Add a candidate codeword to the hash table if it meets weight limits.
+ * @brief Add a candidate codeword to the store if it meets weight limits.
  * 
  * Compares the candidate codeword weight with the current minimum weight and dW limit.
- * If it is within the limits, it is added to the hash. If a new strictly smaller minimum
+ * If it is within the limits, it is added to the store. If a new strictly smaller minimum
  * weight is found, it updates the global minimum weight and prunes heavier codewords
- * from the hash.
+ * from the store.  When the store is full (`cw_cap`), the heaviest codewords
+ * are dropped to make room for a lighter one.
+ *
+ * Thread-safe: only the shard holding the codeword is locked;
+ * `min_w` and `num_cws` are updated atomically, so that the limits
+ * can be checked without a lock.
  *
  * @param p Pointer to the params_t structure.
  * @param arr Array of indices representing the support of the codeword.
  * @param weight Weight of the codeword (length of arr).
- * @return Pointer to the added/existing codeword structure, or NULL if not added.
+ * @return 1 if a new codeword was stored, 0 otherwise.
+ */
+int codeword_add_maybe(params_t * const p, const int arr[], int weight);
+
+/**
+ * @brief All codewords in the store, in the order they were added.
+ *
+ * Not to be used while other threads add codewords.
+ *
+ * @param p Pointer to the params_t structure.
+ * @param num Set to the number of codewords.
+ * @return Newly allocated array of pointers to the stored codewords, free with `free()`.
  */
-cw_vec_t * codeword_add_maybe(params_t * const p, const int arr[], int weight);
+cw_vec_t ** codeword_list(params_t * const p, long long int *num);
 
 #define USAGE								\
   "%s: distance of a classical or quantum CSS code\n"			\
@@ -170,6 +250,14 @@ cw_vec_t * codeword_add_maybe(params_t * const p, const int arr[], int weight);
   "\n"									\
   "\t\t1: random window (RW) algorithm. Options:\n"			\
   "\t\t   steps=[int]: how many information sets to use (1000)\n"		\
+  "\t\t   rwinc=[int]: pivot swaps per incremental information set (0)\n" \
+  "\t\t\t use 0 for a full elimination at every step\n"	\
+  "\t\t   rwsparse=[int]: sparse elimination: 1 yes, 0 no, -1 auto (large H) (-1)\n" \
+  "\t\t   rwgroup=[int]: threads sharing one dense elimination (1)\n" \
+  "\t\t   lb=[int]:    try sums of up to lb dual rows per information set (1)\n" \
+  "\t\t   isd=[str]:   'prange' (single dual rows) or 'stern' (prange)\n" \
+  "\t\t   isdp=[int]:  Stern subset size on each half (2)\n"	\
+  "\t\t   isdl=[int]:  Stern collision window in bits, 0 for auto (0)\n" \
   "\t\t   wmin=[int]:  minimum distance of interest (1)\n"		\
   "\t\t\t immediately stop and return '-w' on a cw of weight w<=wmin\n" \
   "\t\t\t use this option to quickly scan over a large number of codes\n" \
@@ -183,10 +271,23 @@ cw_vec_t * codeword_add_maybe(params_t * const p, const int arr[], int weight);
   "\t\t   cbeg=[int]:  start column to begin CC search (-1)\n"		\
   "\t\t   cend=[int]:  end column to limit CC search (-1)\n"		\
   "\t\t   noscan=[int]: start CC directly with wmax (0)\n" \
+  "\t\t   ccpass=[int]: 1 for a single CC pass over all weights up to wmax,\n" \
+  "\t\t\t instead of one round for each weight (0)\n" \
+  "\t\t   ccbranch=[int]: CC branches on the first unsatisfied row (0), or on\n" \
+  "\t\t\t the one with the fewest columns left (1) (disables smax) (0)\n" \
+  "\t\t   ccmitm=[int]: 1 to meet in the middle, with a table of second halves of\n" \
+  "\t\t\t clusters by their syndrome at half weight (disables smax) (0)\n" \
+  "\t\t   ccmem=[int]: MiB for the ccmitm tables, 0 for a quarter of mem (0)\n" \
+  "\t\t   bz=[int]:    Brouwer-Zimmermann instead of CC: 1 yes, 0 no,\n" \
+  "\t\t\t -1 auto (dense H with method 3) (-1)\n"			\
   "\t\t3: bracketing mode (balanced concurrent RW and CC)\n" \
   "\n"									\
   "   Execution and multithreading parameters:\n"				\
   "\tthreads=[int]: number of threads to use (0 for auto CPU count) (0)\n"	\
+  "\taffinity=[int]: pin threads to CPUs: 0 no, 1 one per core first,\n" \
+  "\t\t 2 pairs of threads on SMT siblings (0)\n"			\
+  "\tmem=[int]: memory budget in MiB, limits RW threads and stored\n"	\
+  "\t\t codewords (0 for the cgroup limit or physical memory) (0)\n"	\
   "\ttimeout=[sec]: timeout in seconds (60.0)\n"				\
   "\tdexp=[int]:    expected distance value for method=3 (alias: dest) (0)\n"				\
   "\n"									\
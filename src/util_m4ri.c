@@ -108,7 +108,120 @@ rci_t mzd_gauss_naive(mzd_t *M, mzp_t *q, int full) {
   return pivots;
 }
 
-/** 
+/** @brief return `n<=64` bits `[col, col+n)` of a raw row as a word */
+static inline word row_read_bits(const word * const row, const rci_t col, const int n){
+  const int spot = SETBT(col);
+  const wi_t blk = SETWD(col);
+  word w = row[blk] >> spot;
+  if (spot + n > m4ri_radix)
+    w |= row[blk+1] << (m4ri_radix - spot);
+  return w & (m4ri_ffff >> (m4ri_radix - n));
+}
+
+/** @brief `dst[beg:end] ^= src[beg:end]` for raw rows */
+static inline void row_xor(word * const dst, const word * const src, const wi_t beg, const wi_t end){
+  for(wi_t j = beg; j < end; j++)
+    dst[j] ^= src[j];
+}
+
+/**
+ * Find up to `k` pivots in columns `[c,c+k)` starting from row `r`.
+ * Same as `_mzd_gauss_submatrix_full()` in m4ri: the rows scanned
+ * are lazily cleared of the pivots already found, the pivot rows are
+ * reduced among themselves.  Stops at the first non-pivot column.
+ * @return the number of pivots found; pivots are in columns
+ * `c, c+1, ...` and rows `r, r+1, ...`.
+ */
+static int gauss_submatrix_full(mzd_t *M, const rci_t r, const rci_t c, const int k){
+  rci_t start_row = r;
+  const wi_t width = M->width;
+  int j;
+  for(j = 0; j < k; j++){
+    int found = 0;
+    for(rci_t i = start_row; i < M->nrows; i++){
+      word * const rowi = mzd_row(M, i);
+      const word tmp = row_read_bits(rowi, c, j + 1);
+      if(tmp){
+	for(int l = 0; l < j; l++) /** clear the pivots found so far */
+	  if((tmp >> l) & 1)
+	    row_xor(rowi, mzd_row_cons(M, r + l), SETWD(c + l), width);
+	if(mzd_read_bit(M, i, c + j)){
+	  mzd_row_swap(M, i, start_row);
+	  const word * const prow = mzd_row_cons(M, start_row);
+	  for(rci_t l = r; l < start_row; l++) /** clear above */
+	    if(mzd_read_bit(M, l, c + j))
+	      row_xor(mzd_row(M, l), prow, SETWD(c + j), width);
+	  start_row++;
+	  found = 1;
+	  break;
+	}
+      }
+    }
+    if(!found)
+      break;
+  }
+  return j;
+}
+
+word * mzd_echelon_m4ri_tab(const mzd_t * const M){
+  word *tab = malloc(sizeof(word) * ((size_t) 1 << M4RI_RW_K) * (M->width > 0 ? M->width : 1));
+  if(!tab)
+    ERROR("memory allocation failed!\n");
+  return tab;
+}
+
+/**
+ * Reduced row echelon form with the Method of Four Russians: `kbar<=K`
+ * pivots are found at a time by `gauss_submatrix_full()`, all `2^kbar`
+ * combinations of the pivot rows are tabulated (one row `XOR` each),
+ * and every other row is reduced with a single table lookup.
+ * Columns are processed left to right, so the pivots are the same as
+ * those given by `gauss_one()` over columns `0, 1, ..., ncols-1`.
+ */
+rci_t mzd_echelon_m4ri(mzd_t *M, mzp_t *q, word * const tab){
+  const rci_t nrows = M->nrows, ncols = M->ncols;
+  const wi_t width = M->width;
+  int k = 1; /** table size `~nrows/4`, as in m4ri */
+  while ((k < M4RI_RW_K) && ((4 << k) <= nrows))
+    k++;
+  rci_t r = 0, c = 0;
+  while((c < ncols) && (r < nrows)){
+    const int kk = (k < ncols - c) ? k : ncols - c;
+    const int kbar = gauss_submatrix_full(M, r, c, kk);
+    if(kbar){
+      const wi_t beg = SETWD(c);
+      const wi_t len = width - beg;
+      /** table of all combinations of pivot rows `r...r+kbar-1` */
+      for(wi_t j = 0; j < len; j++)
+	tab[j] = 0;
+      for(word x = 1; x < ((word) 1 << kbar); x++){
+	word * const dst = tab + x * len;
+	const word * const prev = tab + (x & (x - 1)) * len;
+	const word * const prow = mzd_row_cons(M, r + FIRSTBIT(x)) + beg;
+	for(wi_t j = 0; j < len; j++)
+	  dst[j] = prev[j] ^ prow[j];
+      }
+      for(rci_t i = 0; i < nrows; i++){
+	if(i == r){ /** skip the pivot rows */
+	  i += kbar - 1;
+	  continue;
+	}
+	word * const rowi = mzd_row(M, i);
+	const word x = row_read_bits(rowi, c, kbar);
+	if(x)
+	  row_xor(rowi + beg, tab + x * len, 0, len);
+      }
+      for(int j = 0; j < kbar; j++)
+	q->values[r + j] = c + j;
+      r += kbar;
+    }
+    /** `kbar < kk`: column `c+kbar` is known to be a non-pivot one */
+    c += kbar + (kbar < kk ? 1 : 0);
+  }
+  return r;
+}
+
+/**
  * @brief return max row weight of CSR matrix p
  * TODO: add code for List of Pairs 
  */
@@ -174,6 +287,26 @@ mzd_t *mzd_from_csr(mzd_t *dst, const csr_t *p) {
   return dst;
 }
 
+/**
+ * Convert CSR sparse binary matrix to MZD with columns permuted,
+ * `dst[:,inv[c]] = p[:,c]`; `dst` must be allocated.
+ */
+mzd_t *mzd_from_csr_perm(mzd_t *dst, const csr_t *p, const mzp_t * const inv) {
+  if ((dst->nrows != p->rows) || (dst->ncols != p->cols) || (inv->length != p->cols))
+    ERROR("Wrong size for return matrix.\n");
+  if (p->nz != -1)
+    ERROR("matrix should be in compressed form");
+  mzd_set_ui(dst,0); /* clear bits */
+  for(int i=0;i<p->rows;i++){
+    word * const rawrow = mzd_row(dst,i);
+    for(int j=p->p[i]; j < p->p[i+1] ; j++){
+      const rci_t col = inv->values[p->i[j]];
+      rawrow[SETWD(col)] |= m4ri_one << SETBT(col);
+    }
+  }
+  return dst;
+}
+
 /**
  * Convert a sparse binary matrix CSR into a standard form [ I C ],
  * with some col permutations if needed, create the dense generator
@@ -453,6 +586,34 @@ mzp_t *perm_p_trans(mzp_t *q, const mzp_t *p,const rci_t start){
 }
 
 
+csr_colmask_t * csr_colmask_init(const csr_t * const H){
+  if (H->nz != -1)
+    ERROR("matrix should be in compressed form");
+  csr_colmask_t *M = malloc(sizeof(csr_colmask_t));
+  if (!M)
+    ERROR("memory allocation failed!\n");
+  M->rows = H->rows;
+  M->cols = H->cols;
+  M->width = (H->rows + m4ri_radix - 1) / m4ri_radix;
+  if (M->width == 0)
+    M->width = 1;
+  M->mask = calloc((size_t) M->cols * M->width, sizeof(word));
+  if (!M->mask)
+    ERROR("memory allocation failed!\n");
+  for(int r = 0; r < H->rows; r++)
+    for(int j = H->p[r]; j < H->p[r+1]; j++)
+      M->mask[(size_t) H->i[j] * M->width + SETWD(r)] ^= m4ri_one << SETBT(r);
+  return M;
+}
+
+csr_colmask_t * csr_colmask_free(csr_colmask_t *M){
+  if (M){
+    free(M->mask);
+    free(M);
+  }
+  return NULL;
+}
+
 /**
  * kill a CSR matrix 
  */
@@ -192,6 +192,31 @@ extern "C" {
    */
   rci_t mzd_gauss_naive(mzd_t *M, mzp_t *q, int full);
 
+  /** max number of pivots per table in `mzd_echelon_m4ri()` */
+#define M4RI_RW_K 8
+
+  /**
+   * @brief Allocate the table used by `mzd_echelon_m4ri()` for matrix M.
+   * @param M Matrix to be reduced (only `width` is used).
+   * @return Buffer of `2^M4RI_RW_K` rows of `M->width` words; free with `free()`.
+   */
+  word * mzd_echelon_m4ri_tab(const mzd_t * const M);
+
+  /**
+   * @brief Reduced row echelon form with the Method of Four Russians.
+   *
+   * Pivots are chosen greedily left to right, same as calling
+   * `gauss_one()` on each column in order, but up to `M4RI_RW_K`
+   * pivot rows are applied at once using a table of their linear
+   * combinations.
+   *
+   * @param M Matrix to reduce (modified in place).
+   * @param q Pivot columns are stored in `q->values[0...rank-1]` (increasing).
+   * @param tab Table buffer from `mzd_echelon_m4ri_tab()`.
+   * @return Rank of the matrix.
+   */
+  rci_t mzd_echelon_m4ri(mzd_t *M, mzp_t *q, word * const tab);
+
   /** 
    * @brief Get the maximum row weight of a CSR sparse matrix.
    * @param p Pointer to the CSR sparse matrix.
@@ -220,6 +245,18 @@ extern "C" {
    */
   mzd_t *mzd_from_csr(mzd_t *dst, const csr_t *p);
 
+  /**
+   * @brief Convert a CSR sparse matrix to an MZD dense matrix with permuted columns.
+   *
+   * Column `c` of `p` becomes column `inv->values[c]` of `dst`.
+   *
+   * @param dst Destination dense matrix (must have correct dimensions).
+   * @param p Source sparse matrix (compressed form).
+   * @param inv Column permutation.
+   * @return Pointer to the dense matrix.
+   */
+  mzd_t *mzd_from_csr_perm(mzd_t *dst, const csr_t *p, const mzp_t * const inv);
+
   /**
    * @brief Construct the generator matrix from a parity check matrix in CSR form.
    * 
@@ -481,6 +518,59 @@ static inline int sparse_syndrome_non_zero(const csr_t * const H, const int cnt,
   return 0;
 }
 
+/**
+ * @brief Bit-packed columns of a sparse matrix.
+ *
+ * Column `c` is stored in `mask[c*width ... c*width+width-1]`, bit `r`
+ * set for each non-zero `(r,c)`, so that the syndrome of a vector is
+ * the `XOR` of the masks of the columns in its support.
+ */
+typedef struct {
+  int rows;
+  int cols;
+  int width;  /* words per column, `(rows+63)/64` */
+  word *mask; /* `cols*width` words */
+} csr_colmask_t;
+
+/**
+ * @brief Bit-packed columns of a sparse matrix, see `csr_colmask_t`.
+ * @param H Sparse matrix (compressed CSR form).
+ * @return Newly allocated structure, free with `csr_colmask_free()`.
+ */
+csr_colmask_t * csr_colmask_init(const csr_t * const H);
+
+/** @brief free the column masks, return NULL */
+csr_colmask_t * csr_colmask_free(csr_colmask_t *M);
+
+/**
+ * @brief Check if the syndrome of a sparse vector is non-zero, using column masks.
+ *
+ * Same result as `sparse_syndrome_non_zero()`, at the cost of `cnt*width`
+ * word operations; `ee` need not be sorted.
+ *
+ * @param M Column masks of the check matrix.
+ * @param cnt Weight of the vector.
+ * @param ee Support of the vector (distinct positions).
+ * @return 1 if the syndrome is non-zero, 0 if it is zero.
+ */
+static inline int colmask_syndrome_non_zero(const csr_colmask_t * const M, const int cnt, const int ee[]){
+  const int width = M->width;
+  if (width == 1){
+    word acc = 0;
+    for(int i = 0; i < cnt; i++)
+      acc ^= M->mask[ee[i]];
+    return acc != 0;
+  }
+  for(int w = 0; w < width; w++){
+    word acc = 0;
+    for(int i = 0; i < cnt; i++)
+      acc ^= M->mask[(size_t) ee[i] * width + w];
+    if (acc)
+      return 1;
+  }
+  return 0;
+}
+
   /** 
    * @brief Check if the product of two sparse matrices A * B^T is non-zero.
    * @param A First sparse matrix.
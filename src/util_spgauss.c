@@ -0,0 +1,216 @@
+/************************************************************************
+ * @file util_spgauss.c
+ * @brief sparse Gauss elimination of a CSR matrix with permuted columns
+ *
+ * Used by RW for large LDPC matrices, where a dense copy of `H` per
+ * thread takes `r*n/8` bytes.  Rows are sorted lists of column
+ * indices; row additions are merges.  Only the row echelon form is
+ * kept; the reduced form (dense for most codes) is recovered one
+ * column at a time.  The caller falls back to dense elimination if
+ * the fill gets too large.
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+#include "util_spgauss.h"
+
+/** @brief make sure row `i` can hold `len` entries */
+static inline void row_reserve(spgauss_t *sp, const int i, const int len){
+  if (sp->cap[i] < len){
+    int cap = 2 * sp->cap[i];
+    if (cap < len)
+      cap = len;
+    sp->row[i] = realloc(sp->row[i], sizeof(int) * cap);
+    if (!sp->row[i])
+      ERROR("memory allocation failed!\n");
+    sp->cap[i] = cap;
+  }
+}
+
+/** @brief `row[i] ^= row[m]` by merging sorted lists, update `nz` */
+static inline void row_add(spgauss_t *sp, const int i, const int m){
+  const int * const a = sp->row[i], * const b = sp->row[m];
+  const int la = sp->len[i], lb = sp->len[m];
+  int * const out = sp->buf;
+  int ia = 0, ib = 0, num = 0;
+  while ((ia < la) && (ib < lb)){
+    if (a[ia] < b[ib])
+      out[num++] = a[ia++];
+    else if (a[ia] > b[ib])
+      out[num++] = b[ib++];
+    else {
+      ia++;
+      ib++;
+    }
+  }
+  while (ia < la)
+    out[num++] = a[ia++];
+  while (ib < lb)
+    out[num++] = b[ib++];
+  row_reserve(sp, i, num);
+  memcpy(sp->row[i], out, sizeof(int) * num);
+  sp->nz += num - la;
+  sp->len[i] = num;
+}
+
+spgauss_t * spgauss_init(const csr_t * const H){
+  if (H->nz != -1)
+    ERROR("matrix should be in compressed form");
+  const int r = H->rows, n = H->cols;
+  spgauss_t *sp = calloc(1, sizeof(spgauss_t));
+  if (!sp)
+    ERROR("memory allocation failed!\n");
+  sp->rows = r;
+  sp->cols = n;
+  sp->row = calloc(r + 1, sizeof(int *));
+  sp->len = calloc(r + 1, sizeof(int));
+  sp->cap = calloc(r + 1, sizeof(int));
+  sp->pivrow = malloc(sizeof(int) * (r + 1));
+  sp->pivcol = malloc(sizeof(int) * (r + 1));
+  sp->next = malloc(sizeof(int) * (r + 1));
+  sp->colpiv = malloc(sizeof(int) * (n + 1));
+  sp->head = malloc(sizeof(int) * (n + 1));
+  sp->buf = malloc(sizeof(int) * (n + 1));
+  sp->dual_p = malloc(sizeof(int) * (n + 1));
+  sp->dual_cap = 2 * (long long) H->p[r] + 1;
+  sp->dual_i = malloc(sizeof(int) * sp->dual_cap);
+  if ((!sp->row) || (!sp->len) || (!sp->cap) || (!sp->pivrow) || (!sp->pivcol) || (!sp->next) ||
+      (!sp->colpiv) || (!sp->head) || (!sp->buf) || (!sp->dual_p) || (!sp->dual_i))
+    ERROR("memory allocation failed!\n");
+  for(int i = 0; i < r; i++)
+    row_reserve(sp, i, 2 * (H->p[i+1] - H->p[i]) + 8);
+  return sp;
+}
+
+spgauss_t * spgauss_free(spgauss_t *sp){
+  if (sp){
+    for(int i = 0; i < sp->rows; i++)
+      free(sp->row[i]);
+    free(sp->row);
+    free(sp->len);
+    free(sp->cap);
+    free(sp->pivrow);
+    free(sp->pivcol);
+    free(sp->next);
+    free(sp->colpiv);
+    free(sp->head);
+    free(sp->buf);
+    free(sp->dual_p);
+    free(sp->dual_i);
+    free(sp);
+  }
+  return NULL;
+}
+
+int spgauss_echelon(spgauss_t *sp, const csr_t * const H, const mzp_t * const inv,
+		    mzp_t *q, const long long max_nz){
+  const int r = H->rows, n = H->cols;
+  if ((r != sp->rows) || (n != sp->cols) || (inv->length != n))
+    ERROR("matrix size mismatch");
+
+  /** load the rows with permuted columns, sorted */
+  sp->nz = 0;
+  for(int c = 0; c < n; c++){
+    sp->colpiv[c] = -1;
+    sp->head[c] = -1;
+  }
+  for(int i = 0; i < r; i++){
+    int * const row = sp->row[i];
+    int len = 0;
+    for(int j = H->p[i]; j < H->p[i+1]; j++){
+      const int c = inv->values[H->i[j]];
+      int t = len++;
+      for(; (t > 0) && (row[t-1] > c); t--)
+	row[t] = row[t-1];
+      row[t] = c;
+    }
+    sp->len[i] = len;
+    sp->nz += len;
+    if (len){
+      sp->next[i] = sp->head[row[0]];
+      sp->head[row[0]] = i;
+    }
+  }
+
+  /** forward elimination; rows are kept in lists by the leading column */
+  int rank = 0;
+  for(int c = 0; (c < n) && (rank < r); c++){
+    if (sp->head[c] < 0)
+      continue;
+    int piv = sp->head[c];
+    for(int i = sp->next[piv]; i >= 0; i = sp->next[i])
+      if (sp->len[i] < sp->len[piv])
+	piv = i;
+    for(int i = sp->head[c], nxt; i >= 0; i = nxt){
+      nxt = sp->next[i];
+      if (i == piv)
+	continue;
+      row_add(sp, i, piv);
+      if (sp->nz > max_nz)
+	return -1;
+      if (sp->len[i]){
+	const int lead = sp->row[i][0];
+	sp->next[i] = sp->head[lead];
+	sp->head[lead] = i;
+      }
+    }
+    sp->pivrow[rank] = piv;
+    sp->pivcol[rank] = c;
+    sp->colpiv[c] = rank;
+    q->values[rank++] = c;
+  }
+
+  /** the echelon form by column, without the pivot entries */
+  int * const dp = sp->dual_p;
+  for(int c = 0; c <= n; c++)
+    dp[c] = 0;
+  for(int j = 0; j < rank; j++){
+    const int i = sp->pivrow[j];
+    for(int t = 1; t < sp->len[i]; t++)
+      dp[sp->row[i][t] + 1]++;
+  }
+  for(int c = 0; c < n; c++)
+    dp[c + 1] += dp[c];
+  if (dp[n] > sp->dual_cap){
+    sp->dual_cap = 2 * (long long) dp[n];
+    free(sp->dual_i);
+    sp->dual_i = malloc(sizeof(int) * sp->dual_cap);
+    if (!sp->dual_i)
+      ERROR("memory allocation failed!\n");
+  }
+  int * const pos = sp->buf;
+  memcpy(pos, dp, sizeof(int) * n);
+  for(int j = 0; j < rank; j++){
+    const int i = sp->pivrow[j];
+    for(int t = 1; t < sp->len[i]; t++)
+      sp->dual_i[pos[sp->row[i][t]]++] = j;
+  }
+  sp->rank = rank;
+  return rank;
+}
+
+void spgauss_dual_row(const spgauss_t * const sp, const int c, word * const x, const int nwords){
+  const int * const dp = sp->dual_p, * const di = sp->dual_i;
+  for(int w = 0; w < nwords; w++)
+    x[w] = 0;
+  for(int t = dp[c]; t < dp[c+1]; t++)
+    x[SETWD(di[t])] |= m4ri_one << SETBT(di[t]);
+  /** back substitution, highest pivot first; only lower bits change */
+  for(int w = SETWD(sp->rank + m4ri_radix - 1) - 1; w >= 0; w--){
+    word cur = x[w];
+    while(cur){
+      const int b = m4ri_radix - 1 - __builtin_clzll(cur);
+      const int m = w * m4ri_radix + b;
+      const int qm = sp->pivcol[m];
+      for(int t = dp[qm]; t < dp[qm+1]; t++)
+	x[SETWD(di[t])] ^= m4ri_one << SETBT(di[t]);
+      cur = x[w] & ((m4ri_one << b) - 1);
+    }
+  }
+}
@@ -0,0 +1,101 @@
+#ifndef UTIL_SPGAUSS_H
+#define UTIL_SPGAUSS_H
+
+/************************************************************************
+ * @file util_spgauss.h
+ * @brief sparse Gauss elimination of a CSR matrix with permuted columns
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <m4ri/m4ri.h>
+
+#include "util_m4ri.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** fall back to dense elimination once the sparse rows hold more than
+    `rows*cols/SPGAUSS_FILL` non-zeros (half the size of a dense matrix) */
+#define SPGAUSS_FILL 64
+
+/**
+ * @brief Work space for sparse elimination of an `r` by `n` matrix.
+ *
+ * Rows are kept as sorted lists of (permuted) column indices.  After
+ * `spgauss_echelon()` the row echelon form is also available column
+ * by column, without the pivot entries: the pivots `j` with a
+ * non-zero in the (permuted) column `c` are
+ * `dual_i[dual_p[c]...dual_p[c+1]-1]`, in increasing order.
+ */
+typedef struct {
+  int rows, cols;
+  int rank;
+  int **row;       /* row `i` is `row[i][0...len[i]-1]`, increasing */
+  int *len;
+  int *cap;
+  int *pivrow;     /* storage row of pivot `j` */
+  int *pivcol;     /* column of pivot `j` */
+  int *colpiv;     /* pivot index of each column, or -1 */
+  int *head;       /* rows with the leading entry in each column */
+  int *next;
+  int *buf;        /* scratch, `cols` entries */
+  int *dual_p;     /* `cols+1` column offsets */
+  int *dual_i;     /* pivots by column */
+  long long dual_cap;
+  long long nz;    /* current number of non-zeros */
+} spgauss_t;
+
+/**
+ * @brief Allocate the work space for matrices of the size of `H`.
+ * @param H Sparse matrix (compressed CSR form).
+ * @return Newly allocated structure, free with `spgauss_free()`.
+ */
+spgauss_t * spgauss_init(const csr_t * const H);
+
+/** @brief free the work space, return NULL */
+spgauss_t * spgauss_free(spgauss_t *sp);
+
+/**
+ * @brief Row echelon form of `H` with permuted columns.
+ *
+ * Column `c` of `H` goes to position `inv->values[c]`.  Pivot columns
+ * are chosen greedily left to right, as in `mzd_echelon_m4ri()`, so
+ * the information set is the same as for the dense elimination.
+ * Among the rows with the leading entry in the current column the
+ * sparsest one is used as the pivot row (Markowitz).
+ *
+ * @param sp Work space.
+ * @param H Sparse matrix (compressed CSR form).
+ * @param inv Column permutation.
+ * @param q Pivot columns are stored in `q->values[0...rank-1]` (increasing).
+ * @param max_nz Give up once the rows hold more than this many non-zeros.
+ * @return Rank of the matrix, or -1 if `max_nz` was exceeded.
+ */
+int spgauss_echelon(spgauss_t *sp, const csr_t * const H, const mzp_t * const inv,
+		    mzp_t *q, const long long max_nz);
+
+/**
+ * @brief Column `c` of the reduced row echelon form.
+ *
+ * Back substitution in the echelon form from `spgauss_echelon()`;
+ * bit `j` of the result is set if pivot row `j` of the reduced matrix
+ * has a non-zero in column `c`, i.e., it is the dual row of a
+ * non-pivot column `c`, same as with dense elimination.
+ *
+ * @param sp Work space after `spgauss_echelon()`.
+ * @param c Column (permuted position).
+ * @param x Result, `nwords` words.
+ * @param nwords Length of `x`, at least `(rank+63)/64`.
+ */
+void spgauss_dual_row(const spgauss_t * const sp, const int c, word * const x, const int nwords);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTIL_SPGAUSS_H */
@@ -0,0 +1,299 @@
+/************************************************************************
+ * @file util_sys.c
+ * @brief CPU topology and thread placement (Linux; no-op elsewhere)
+ *
+ * The topology is read from `/sys/devices/system/cpu`; a CPU without
+ * the topology files counts as a separate core on NUMA node 0.  The
+ * cgroup limits are read from `/sys/fs/cgroup`, with the path of the
+ * cgroup from `/proc/self/cgroup`.
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+#include "util_sys.h"
+
+#ifdef __linux__
+
+/** @brief one logical CPU: hyperthread `smt` of core `rank` on its NUMA node */
+typedef struct {
+  int cpu, node, pkg, core;
+  int rank, smt;
+} sys_cpu_t;
+
+/** @brief read an integer from a `sysfs` file, `def` if not available */
+static int sys_read_int(const char * const fmt, const int cpu, const int def){
+  char name[128];
+  snprintf(name, sizeof(name), fmt, cpu);
+  FILE *f = fopen(name, "r");
+  int val = def;
+  if (f){
+    if (fscanf(f, "%d", &val) != 1)
+      val = def;
+    fclose(f);
+  }
+  return val;
+}
+
+int sys_cpu_node(const int cpu){
+  char name[64];
+  snprintf(name, sizeof(name), "/sys/devices/system/cpu/cpu%d", cpu);
+  DIR *d = opendir(name);
+  int node = 0;
+  if (d){
+    const struct dirent *e;
+    while ((e = readdir(d)))
+      if (sscanf(e->d_name, "node%d", &node) == 1)
+	break;
+    closedir(d);
+  }
+  return node;
+}
+
+/** @brief by node, core, CPU */
+static int by_core(const void *a, const void *b){
+  const sys_cpu_t * const x = a, * const y = b;
+  if (x->node != y->node) return x->node - y->node;
+  if (x->pkg != y->pkg) return x->pkg - y->pkg;
+  if (x->core != y->core) return x->core - y->core;
+  return x->cpu - y->cpu;
+}
+
+/** @brief first hyperthreads of all cores first, nodes in turn */
+static int by_spread(const void *a, const void *b){
+  const sys_cpu_t * const x = a, * const y = b;
+  if (x->smt != y->smt) return x->smt - y->smt;
+  if (x->rank != y->rank) return x->rank - y->rank;
+  return x->node - y->node;
+}
+
+/** @brief cores with nodes in turn, hyperthreads of a core together */
+static int by_smt(const void *a, const void *b){
+  const sys_cpu_t * const x = a, * const y = b;
+  if (x->rank != y->rank) return x->rank - y->rank;
+  if (x->node != y->node) return x->node - y->node;
+  return x->smt - y->smt;
+}
+
+int sys_cpu_order(int * const cpu, const int max, const int mode){
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0)
+    return 0;
+  const int num = CPU_COUNT(&set);
+  sys_cpu_t *c = malloc(sizeof(sys_cpu_t) * (num + 1));
+  if (!c)
+    return 0;
+  int cnt = 0;
+  for(int i = 0; (i < CPU_SETSIZE) && (cnt < num); i++){
+    if (!CPU_ISSET(i, &set))
+      continue;
+    c[cnt].cpu = i;
+    c[cnt].node = sys_cpu_node(i);
+    c[cnt].pkg = sys_read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i, 0);
+    c[cnt].core = sys_read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", i, -1 - i);
+    cnt++;
+  }
+  qsort(c, cnt, sizeof(sys_cpu_t), by_core);
+  for(int i = 0, rank = 0; i < cnt; i++){
+    if ((i > 0) && (c[i].node != c[i-1].node))
+      rank = 0;
+    else if ((i > 0) && ((c[i].pkg != c[i-1].pkg) || (c[i].core != c[i-1].core)))
+      rank++;
+    c[i].rank = rank;
+    c[i].smt = ((i > 0) && (c[i].node == c[i-1].node) && (c[i].pkg == c[i-1].pkg) &&
+		(c[i].core == c[i-1].core)) ? c[i-1].smt + 1 : 0;
+  }
+  qsort(c, cnt, sizeof(sys_cpu_t), mode == SYS_AFFINITY_SMT ? by_smt : by_spread);
+  if (cnt > max)
+    cnt = max;
+  for(int i = 0; i < cnt; i++)
+    cpu[i] = c[i].cpu;
+  free(c);
+  return cnt;
+}
+
+/**
+ * @brief path of the cgroup of this process for the v1 controller
+ * `ctrl`, or the v2 path if `ctrl` is NULL; "" if not found.
+ */
+static void sys_cgroup_path(const char * const ctrl, char * const path, const size_t len){
+  path[0] = '\0';
+  FILE *f = fopen("/proc/self/cgroup", "r");
+  if (!f)
+    return;
+  char line[4096];
+  while (fgets(line, sizeof(line), f)){
+    /** `id:controller,list:/path` */
+    char * const c = strchr(line, ':');
+    char * const d = c ? strchr(c + 1, ':') : NULL;
+    if (!d)
+      continue;
+    *d = '\0';
+    int match = 0;
+    if (!ctrl)
+      match = (c[1] == '\0');
+    else
+      for(char *tok = strtok(c + 1, ","); tok; tok = strtok(NULL, ","))
+        if (strcmp(tok, ctrl) == 0)
+          match = 1;
+    if (match){
+      snprintf(path, len, "%s", d + 1);
+      path[strcspn(path, "\n")] = '\0';
+      break;
+    }
+  }
+  fclose(f);
+}
+
+/**
+ * @brief smallest positive value of `val(dir/file)` over the cgroup
+ * `mnt/rel` and its parents up to `mnt`, 0 if none.
+ *
+ * The parents are read since their limits also apply; in a container
+ * `rel` is often a host path, and only `mnt` itself exists.
+ */
+static long long sys_cgroup_min(const char * const mnt, const char * const rel, const char * const file,
+                                long long (*val)(const char *dir)){
+  char dir[4096];
+  if (snprintf(dir, sizeof(dir), "%s%s", mnt, rel) >= (int) sizeof(dir))
+    return 0;
+  const size_t len = strlen(mnt);
+  long long res = 0;
+  while (1){
+    char name[4200];
+    snprintf(name, sizeof(name), "%s/%s", dir, file);
+    if (access(name, R_OK) == 0){
+      const long long v = val(dir);
+      if ((v > 0) && ((res == 0) || (v < res)))
+        res = v;
+    }
+    char * const slash = strrchr(dir, '/');
+    if ((!slash) || (strlen(dir) <= len))
+      break;
+    *slash = '\0';
+  }
+  return res;
+}
+
+/** @brief first number in the file `dir/file`, -1 if none (e.g. "max") */
+static long long sys_read_ll(const char * const dir, const char * const file){
+  char name[4200];
+  snprintf(name, sizeof(name), "%s/%s", dir, file);
+  FILE *f = fopen(name, "r");
+  long long val = -1;
+  if (f){
+    if (fscanf(f, "%lld", &val) != 1)
+      val = -1;
+    fclose(f);
+  }
+  return val;
+}
+
+/** @brief CPUs of the CFS quota, rounded up, v2 */
+static long long sys_cpu_max(const char * const dir){
+  char name[4200];
+  snprintf(name, sizeof(name), "%s/cpu.max", dir);
+  FILE *f = fopen(name, "r");
+  long long quota = -1, period = 0;
+  if (f){
+    if (fscanf(f, "%lld %lld", &quota, &period) != 2)
+      quota = -1; /** `max`, no limit */
+    fclose(f);
+  }
+  return ((quota > 0) && (period > 0)) ? (quota + period - 1) / period : 0;
+}
+
+/** @brief CPUs of the CFS quota, rounded up, v1 */
+static long long sys_cpu_cfs(const char * const dir){
+  const long long quota = sys_read_ll(dir, "cpu.cfs_quota_us");
+  const long long period = sys_read_ll(dir, "cpu.cfs_period_us");
+  return ((quota > 0) && (period > 0)) ? (quota + period - 1) / period : 0;
+}
+
+static long long sys_mem_max(const char * const dir){ return sys_read_ll(dir, "memory.max"); }
+static long long sys_mem_v1(const char * const dir){ return sys_read_ll(dir, "memory.limit_in_bytes"); }
+
+/** @brief the smaller positive one of `a` and `b`, 0 if none */
+static long long sys_min_limit(const long long a, const long long b){
+  if (a <= 0) return b > 0 ? b : 0;
+  return ((b > 0) && (b < a)) ? b : a;
+}
+
+int sys_cpu_count(void){
+  cpu_set_t set;
+  long long num = 0;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    num = CPU_COUNT(&set);
+  if (num <= 0)
+    num = sysconf(_SC_NPROCESSORS_ONLN);
+  char rel[4096];
+  long long quota = 0;
+  sys_cgroup_path(NULL, rel, sizeof(rel));
+  if (rel[0])
+    quota = sys_cgroup_min("/sys/fs/cgroup", rel, "cpu.max", sys_cpu_max);
+  sys_cgroup_path("cpu", rel, sizeof(rel));
+  if (rel[0]){
+    quota = sys_min_limit(quota, sys_cgroup_min("/sys/fs/cgroup/cpu", rel, "cpu.cfs_quota_us", sys_cpu_cfs));
+    quota = sys_min_limit(quota, sys_cgroup_min("/sys/fs/cgroup/cpu,cpuacct", rel, "cpu.cfs_quota_us", sys_cpu_cfs));
+  }
+  num = sys_min_limit(num, quota);
+  return num > 0 ? (int) num : 1;
+}
+
+long long sys_mem_limit(void){
+  const long long pages = sysconf(_SC_PHYS_PAGES), page = sysconf(_SC_PAGE_SIZE);
+  long long mem = ((pages > 0) && (page > 0)) ? pages * page : 0;
+  char rel[4096];
+  sys_cgroup_path(NULL, rel, sizeof(rel));
+  if (rel[0])
+    mem = sys_min_limit(mem, sys_cgroup_min("/sys/fs/cgroup", rel, "memory.max", sys_mem_max));
+  sys_cgroup_path("memory", rel, sizeof(rel));
+  if (rel[0])
+    mem = sys_min_limit(mem, sys_cgroup_min("/sys/fs/cgroup/memory", rel, "memory.limit_in_bytes", sys_mem_v1));
+  return mem;
+}
+
+int sys_pin_self(const int cpu){
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+#else /* not __linux__ */
+
+int sys_cpu_order(int * const cpu, const int max, const int mode){
+  (void) cpu; (void) max; (void) mode;
+  return 0;
+}
+
+int sys_cpu_count(void){
+  const long num = sysconf(_SC_NPROCESSORS_ONLN);
+  return num > 0 ? (int) num : 1;
+}
+
+long long sys_mem_limit(void){
+  return 0;
+}
+
+int sys_cpu_node(const int cpu){
+  (void) cpu;
+  return 0;
+}
+
+int sys_pin_self(const int cpu){
+  (void) cpu;
+  return -1;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,69 @@
+#ifndef UTIL_SYS_H
+#define UTIL_SYS_H
+
+/************************************************************************
+ * @file util_sys.h
+ * @brief CPU topology and thread placement (Linux; no-op elsewhere)
+ *
+ * author: Leonid Pryadko <leonid.pryadko@ucr.edu>
+ ************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** worker placement modes, `affinity=` */
+#define SYS_AFFINITY_NONE   0 /* threads are not pinned */
+#define SYS_AFFINITY_SPREAD 1 /* one thread per physical core first, NUMA nodes interleaved */
+#define SYS_AFFINITY_SMT    2 /* threads `2j` and `2j+1` on hyperthreads of the same core */
+
+/**
+ * @brief CPUs for the worker threads, in the order of placement mode `mode`.
+ *
+ * Only the CPUs the process may run on are used.  Physical cores
+ * are taken from different NUMA nodes in turn.  With
+ * `SYS_AFFINITY_SPREAD` the first hyperthread of every core comes
+ * first, then the second ones, and so on; with `SYS_AFFINITY_SMT`
+ * all hyperthreads of a core are consecutive.
+ *
+ * @param cpu Result, CPU number for each thread.
+ * @param max Length of `cpu`.
+ * @param mode `SYS_AFFINITY_SPREAD` or `SYS_AFFINITY_SMT`.
+ * @return Number of CPUs in the list, 0 if not supported.
+ */
+int sys_cpu_order(int * const cpu, const int max, const int mode);
+
+/**
+ * @brief Number of CPUs the process can use.
+ *
+ * The CPUs in the affinity mask (which reflects the cpuset), reduced
+ * to the CFS quota of the cgroup (v2 `cpu.max` or v1
+ * `cpu.cfs_quota_us`) if there is one, rounded up.
+ *
+ * @return At least 1.
+ */
+int sys_cpu_count(void);
+
+/**
+ * @brief Memory the process can use in bytes: the smallest of the
+ * physical memory and the cgroup limits (v2 `memory.max` or v1
+ * `memory.limit_in_bytes`) of its cgroup and of the ones above it.
+ * @return 0 if not known.
+ */
+long long sys_mem_limit(void);
+
+/** @brief NUMA node of the CPU, 0 if not known */
+int sys_cpu_node(const int cpu);
+
+/**
+ * @brief Pin the calling thread to one CPU.  Memory the thread touches
+ * first afterwards is then allocated on its NUMA node.
+ * @return 0 on success, -1 otherwise.
+ */
+int sys_pin_self(const int cpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTIL_SYS_H */